@@ -1,6 +1,11 @@
 #include <FullLoopbackStream.h>
 
-FullLoopbackStream::FullLoopbackStream(uint16_t buffer_size) : LoopbackStream(buffer_size){};
+FullLoopbackStream::FullLoopbackStream(size_t buffer_size, bool usePsram) : ring(buffer_size, usePsram){};
+
+size_t FullLoopbackStream::write(uint8_t data)
+{
+    return ring.write(&data, 1);
+}
 
 size_t FullLoopbackStream::write(const char *str)
 {
@@ -9,15 +14,57 @@ size_t FullLoopbackStream::write(const char *str)
     return write((const uint8_t *)str, strlen(str));
 }
 
+size_t FullLoopbackStream::write(const char *buffer, size_t size)
+{
+    return write((const uint8_t *)buffer, size);
+}
+
 size_t FullLoopbackStream::write(const uint8_t *buffer, size_t size)
 {
-    size_t n = 0;
-    while (size--)
-    {
-        if (write(*buffer++))
-            n++;
-        else
-            break;
-    }
-    return n;
-}
\ No newline at end of file
+    return ring.write(buffer, size);
+}
+
+int FullLoopbackStream::availableForWrite()
+{
+    return ring.space();
+}
+
+int FullLoopbackStream::available()
+{
+    return ring.available();
+}
+
+int FullLoopbackStream::read()
+{
+    return ring.read();
+}
+
+int FullLoopbackStream::peek()
+{
+    return ring.peek();
+}
+
+size_t FullLoopbackStream::readBytes(char *buffer, size_t length)
+{
+    return ring.read((uint8_t *)buffer, length);
+}
+
+void FullLoopbackStream::flush()
+{
+    // Nothing to do, data is readable as soon as it's written
+}
+
+void FullLoopbackStream::clear()
+{
+    ring.clear();
+}
+
+size_t FullLoopbackStream::peekContiguous(const uint8_t **data)
+{
+    return ring.peekContiguous(data);
+}
+
+void FullLoopbackStream::consume(size_t size)
+{
+    ring.consume(size);
+}
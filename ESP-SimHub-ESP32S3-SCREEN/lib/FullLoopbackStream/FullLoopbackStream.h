@@ -1,18 +1,47 @@
 #pragma once
 
-#include <LoopbackStream.h>
+#include <Arduino.h>
+#include <SpscRingBuffer.h>
 
 /**
- * Same as LoopbackStream, but it includes extra methods to handle what we need from it
- *  basically we're just completing the existing usages of Serial
+ * Loopback Stream (whatever is written can be read back) over a lock-free SPSC ring,
+ *  completing the usages of Serial that the SimHub protocol needs.
+ *
+ * Besides the Stream interface it exposes the ring segments directly, so a consumer
+ *  like the TCP bridge can send straight from the buffer (peekContiguous/consume)
+ *  without copying into a temporary one first.
  */
-class FullLoopbackStream : public LoopbackStream
+class FullLoopbackStream : public Stream
 {
 public:
-    FullLoopbackStream(uint16_t buffer_size = LoopbackStream::DEFAULT_SIZE);
+    static const uint16_t DEFAULT_SIZE = 64;
 
-    size_t write(const uint8_t *buffer, size_t size);
+    // usePsram puts the buffer in external RAM, for streams that must absorb large bursts
+    FullLoopbackStream(size_t buffer_size = DEFAULT_SIZE, bool usePsram = false);
+
+    size_t write(uint8_t data) override;
+    size_t write(const uint8_t *buffer, size_t size) override;
     size_t write(const char *buffer, size_t size);
     size_t write(const char *str);
-    using LoopbackStream::write;
+    using Print::write;
+
+    int availableForWrite() override;
+    int available() override;
+    int read() override;
+    int peek() override;
+    // Bulk paths: copy what is available (at most two spans across the wrap) and
+    //  return at once, instead of Stream's byte-by-byte timedRead with a timeout
+    size_t readBytes(char *buffer, size_t length) override;
+    size_t readBytes(uint8_t *buffer, size_t length) { return readBytes((char *)buffer, length); }
+    void flush() override;
+    void clear();
+
+    size_t peekContiguous(const uint8_t **data);
+    void consume(size_t size);
+
+    // bytes dropped because the buffer was full
+    uint32_t getOverflowBytes() { return ring.getOverflowBytes(); }
+
+private:
+    SpscRingBuffer ring;
 };
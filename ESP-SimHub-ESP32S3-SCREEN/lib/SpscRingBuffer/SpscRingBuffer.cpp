@@ -0,0 +1,125 @@
+#include <SpscRingBuffer.h>
+#ifdef ESP_PLATFORM
+#include <esp_heap_caps.h>
+#endif
+
+static size_t roundUpToPowerOfTwo(size_t value)
+{
+    size_t result = 1;
+    while (result < value)
+        result <<= 1;
+    return result;
+}
+
+SpscRingBuffer::SpscRingBuffer(size_t capacity, bool usePsram) : buffer(nullptr), inPsram(false), head(0), tail(0), overflowBytes(0), overflowCount(0)
+{
+    size_t size = roundUpToPowerOfTwo(capacity < 2 ? 2 : capacity);
+#ifdef ESP_PLATFORM
+    if (usePsram && psramFound())
+    {
+        buffer = (uint8_t *)heap_caps_malloc(size, MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT);
+        inPsram = buffer != nullptr;
+    }
+#endif
+    if (!buffer)
+        buffer = (uint8_t *)malloc(size);
+    mask = buffer ? size - 1 : 0;
+}
+
+SpscRingBuffer::~SpscRingBuffer()
+{
+    free(buffer);
+}
+
+size_t SpscRingBuffer::space() const
+{
+    return capacity() - (head.load(std::memory_order_relaxed) - tail.load(std::memory_order_acquire));
+}
+
+size_t SpscRingBuffer::available() const
+{
+    return head.load(std::memory_order_acquire) - tail.load(std::memory_order_relaxed);
+}
+
+size_t SpscRingBuffer::write(const uint8_t *data, size_t size)
+{
+    if (!buffer)
+        return 0;
+
+    size_t h = head.load(std::memory_order_relaxed);
+    size_t room = capacity() - (h - tail.load(std::memory_order_acquire));
+    size_t n = size < room ? size : room;
+    if (n < size)
+    {
+        overflowBytes.fetch_add(size - n, std::memory_order_relaxed);
+        overflowCount.fetch_add(1, std::memory_order_relaxed);
+    }
+    if (n == 0)
+        return 0;
+
+    size_t start = h & mask;
+    size_t first = capacity() - start;
+    if (first > n)
+        first = n;
+    memcpy(buffer + start, data, first);
+    memcpy(buffer, data + first, n - first);
+
+    head.store(h + n, std::memory_order_release);
+    return n;
+}
+
+size_t SpscRingBuffer::read(uint8_t *data, size_t size)
+{
+    size_t t = tail.load(std::memory_order_relaxed);
+    size_t used = head.load(std::memory_order_acquire) - t;
+    size_t n = size < used ? size : used;
+    if (n == 0)
+        return 0;
+
+    size_t start = t & mask;
+    size_t first = capacity() - start;
+    if (first > n)
+        first = n;
+    memcpy(data, buffer + start, first);
+    memcpy(data + first, buffer, n - first);
+
+    tail.store(t + n, std::memory_order_release);
+    return n;
+}
+
+int SpscRingBuffer::read()
+{
+    uint8_t value;
+    return read(&value, 1) ? value : -1;
+}
+
+int SpscRingBuffer::peek() const
+{
+    size_t t = tail.load(std::memory_order_relaxed);
+    if (head.load(std::memory_order_acquire) == t)
+        return -1;
+    return buffer[t & mask];
+}
+
+size_t SpscRingBuffer::peekContiguous(const uint8_t **data) const
+{
+    size_t t = tail.load(std::memory_order_relaxed);
+    size_t used = head.load(std::memory_order_acquire) - t;
+    size_t start = t & mask;
+    size_t first = capacity() - start;
+    *data = buffer + start;
+    return used < first ? used : first;
+}
+
+void SpscRingBuffer::consume(size_t size)
+{
+    size_t t = tail.load(std::memory_order_relaxed);
+    size_t used = head.load(std::memory_order_acquire) - t;
+    tail.store(t + (size < used ? size : used), std::memory_order_release);
+}
+
+// Consumer side only: drops everything the producer has published so far
+void SpscRingBuffer::clear()
+{
+    tail.store(head.load(std::memory_order_acquire), std::memory_order_release);
+}
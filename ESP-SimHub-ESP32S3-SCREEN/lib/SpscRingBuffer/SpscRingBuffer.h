@@ -0,0 +1,61 @@
+#pragma once
+
+#include <Arduino.h>
+#include <atomic>
+
+/**
+ * Fixed-capacity, lock-free byte ring for exactly one producer and one consumer
+ *  (e.g. the BLE task writing and the main loop reading). Head is only written by
+ *  the producer and tail only by the consumer, so no lock is needed; the indices
+ *  run free and are masked, which keeps full/empty unambiguous.
+ *
+ * Both ends copy in bulk with at most two memcpy calls (before and after the wrap).
+ *  Bytes that don't fit are dropped and counted in the overflow counters.
+ *
+ * The consumer can also skip the copy: peekContiguous() exposes the readable bytes
+ *  that sit in one piece before the wrap, and consume() releases them once used.
+ *
+ * Producer and consumer may run on different cores (e.g. the AsyncTCP task and the
+ *  Arduino loop): the data is published by the release store of head and seen
+ *  after the acquire load on the other side. Large rings can live in PSRAM, which
+ *  the S3 serves through a cache shared by both cores.
+ */
+class SpscRingBuffer
+{
+public:
+    // capacity is rounded up to a power of two; with usePsram the storage goes to
+    //  external RAM when there is some, falling back to the internal heap. PSRAM is
+    //  only detected after psramInit(), so construct PSRAM rings from setup(), not
+    //  as globals. Off the ESP32 (native tests) the heap is always used
+    SpscRingBuffer(size_t capacity, bool usePsram = false);
+    ~SpscRingBuffer();
+
+    // Producer side
+    size_t write(const uint8_t *data, size_t size);
+    size_t space() const;
+
+    // Consumer side
+    size_t read(uint8_t *data, size_t size);
+    int read();
+    int peek() const;
+    size_t available() const;
+    void clear();
+
+    // Consumer side, zero-copy: pointer to the next contiguous readable segment
+    size_t peekContiguous(const uint8_t **data) const;
+    void consume(size_t size);
+
+    size_t capacity() const { return mask + 1; }
+    bool isInPsram() const { return inPsram; }
+    uint32_t getOverflowBytes() const { return overflowBytes.load(std::memory_order_relaxed); }
+    uint32_t getOverflowCount() const { return overflowCount.load(std::memory_order_relaxed); }
+
+private:
+    uint8_t *buffer;
+    size_t mask;
+    bool inPsram;
+    std::atomic<size_t> head;
+    std::atomic<size_t> tail;
+    std::atomic<uint32_t> overflowBytes;
+    std::atomic<uint32_t> overflowCount;
+};
@@ -20,9 +20,9 @@ class ECrowneWifi {
 
 // these will override the Serial interface that SimHub uses to use our Streams
 #define FlowSerialBegin [](unsigned long baud) {}
-#define StreamRead incomingStream.read
-#define StreamAvailable incomingStream.available
+#define StreamRead incomingStream->read
+#define StreamAvailable incomingStream->available
 #define FlowSerialFlush ECrowneWifi::flush
 #define StreamFlush ECrowneWifi::flush
-#define StreamWrite outgoingStream.write
-#define StreamPrint outgoingStream.print
\ No newline at end of file
+#define StreamWrite outgoingStream->write
+#define StreamPrint outgoingStream->print
\ No newline at end of file
@@ -8,6 +8,7 @@
 #endif
 #include <FullLoopbackStream.h>
 #include <GFXHelpers.h>
+#include <UdpTelemetry.h>
 #include "Config.h"
 
 
@@ -43,7 +44,25 @@
 
 #endif
 
-#define WIFICHECK_INTERVAL    1000L
+// After a drop the link is brought back by a state machine polled from the loop:
+//  WiFi events only raise flags, and each attempt is a non-blocking WiFi.begin()
+//  on the stored config, spaced by an exponential backoff. Nothing waits on the
+//  radio, so LEDs, display and inputs keep running on the last data meanwhile.
+// The stored config is pinned to the BSSID and channel of the last association,
+//  so after a few failed attempts an async scan looks for the strongest AP with
+//  the same SSID (the router moved channel, or another AP of the mesh is closer).
+#define WIFI_RECONNECT_MIN_BACKOFF_MS   250L
+#define WIFI_RECONNECT_MAX_BACKOFF_MS   8000L
+#define WIFI_RECONNECT_ATTEMPT_MS       10000L
+#define WIFI_RECONNECT_SCAN_AFTER       3       // failed attempts before a rescan
+#define WIFI_RECONNECT_SCAN_MS          8000L   // gives up on a scan that never completes
+
+enum WiFiLinkState : uint8_t {
+  WIFI_LINK_CONNECTED,
+  WIFI_LINK_BACKOFF,      // waiting before the next attempt
+  WIFI_LINK_CONNECTING,   // attempt in progress
+  WIFI_LINK_SCANNING      // async scan for the SSID in progress
+};
 
 // a list to hold all clients
 static std::vector<AsyncClient*> clients;
@@ -78,6 +97,23 @@ typedef struct
 
 WM_Config WM_config;
 
+// Last successful association, stored after WM_config in the same file so the
+//  next boot can connect straight to that AP and channel instead of scanning.
+//  The address still comes from DHCP on every boot, so an expired lease never
+//  turns into a conflict. A stale entry costs WIFI_FAST_CONNECT_TIMEOUT_MS, then
+//  the normal path runs. The file is only read once LittleFS is mounted, so the
+//  shortcut starts after the mount and the WiFiManager setup, not at power-on.
+typedef struct
+{
+  uint8_t  bssid[6];
+  int32_t  channel;
+  uint16_t checksum;
+} WiFi_FastConnect;
+
+WiFi_FastConnect WM_fastConnect;
+
+#define WIFI_FAST_CONNECT_TIMEOUT_MS    3000L
+
 // Stores whether ESP has WiFi credentials saved from previous session
 bool initialConfig = false;
 
@@ -141,41 +177,169 @@ uint8_t connectMultiWiFi()
   }
   else
   {
+    // no restart: check_status() keeps retrying in the background
     LOGERROR(F("WiFi not connected"));
-
-#if ESP8266
-    ESP.reset();
-#else
-    ESP.restart();
-#endif
   }
 
   return status;
 }
 
-void check_WiFi()
+static volatile bool wifiLinkLost = false;
+static WiFiLinkState wifiLinkState = WIFI_LINK_BACKOFF;
+static unsigned long wifiLinkStateSince = 0;
+static unsigned long wifiBackoffMs = WIFI_RECONNECT_MIN_BACKOFF_MS;
+static uint32_t wifiReconnectAttempts = 0;
+static uint32_t wifiReconnects = 0;
+static uint8_t wifiFailedAttempts = 0;    // in a row, since the last scan
+
+static void setWiFiLinkState(WiFiLinkState state)
+{
+  wifiLinkState = state;
+  wifiLinkStateSince = millis();
+}
+
+#ifdef ESP32
+// Runs on the WiFi event task, so it only raises a flag for check_status()
+static void handleWiFiEvent(WiFiEvent_t event, WiFiEventInfo_t info)
 {
-  if ( (WiFi.status() != WL_CONNECTED) )
+  if (event == ARDUINO_EVENT_WIFI_STA_DISCONNECTED) {
+    wifiLinkLost = true;
+  }
+}
+#endif
+
+// Once, after the first connection attempt in setup
+void beginWiFiReconnect()
+{
+  // the reconnect attempts and their pacing are ours, not the driver's
+  WiFi.setAutoReconnect(false);
+#ifdef ESP32
+  WiFi.onEvent(handleWiFiEvent);
+#endif
+  wifiLinkLost = false;
+  setWiFiLinkState(WiFi.status() == WL_CONNECTED ? WIFI_LINK_CONNECTED : WIFI_LINK_BACKOFF);
+}
+
+// Network the rescan looks for; false when there are no credentials to use
+static bool getReconnectCredentials(const char **ssid, const char **pass)
+{
+#if USE_HARDCODED_CREDENTIALS
+#else
+  if (WM_config.WiFi_Creds[0].wifi_ssid[0] != 0)
   {
-#if DEBUG_TCP_BRIDGE
-    Serial.println(F("\nWiFi lost. Call connectMultiWiFi in loop"));
+    *ssid = WM_config.WiFi_Creds[0].wifi_ssid;
+    *pass = WM_config.WiFi_Creds[0].wifi_pw;
+    return true;
+  }
 #endif
-    connectMultiWiFi();
+  *ssid = Router_SSID.c_str();
+  *pass = Router_Pass.c_str();
+  return Router_SSID != "";
+}
+
+// Connects to the strongest AP of the scan that carries our SSID. Without a
+//  match (or a scan) the driver gets the SSID alone and searches all channels
+static void beginAfterScan(int16_t found)
+{
+  const char *ssid;
+  const char *pass;
+  if (!getReconnectCredentials(&ssid, &pass))
+  {
+    WiFi.begin();
+    return;
+  }
+
+  int16_t best = -1;
+  for (int16_t i = 0; i < found; i++)
+  {
+    if ( (WiFi.SSID(i) == ssid) && ( (best < 0) || (WiFi.RSSI(i) > WiFi.RSSI(best)) ) )
+    {
+      best = i;
+    }
+  }
+
+  if (best >= 0)
+  {
+    LOGERROR3(F("WiFi rescan found "), ssid, F(" on channel "), WiFi.channel(best));
+    WiFi.begin(ssid, pass, WiFi.channel(best), WiFi.BSSID(best));
+  }
+  else
+  {
+    WiFi.begin(ssid, pass);
+  }
+  if (found > 0)
+  {
+    WiFi.scanDelete();
   }
 }
 
 void check_status()
 {
-  static ulong checkstatus_timeout = 0;
-  static ulong checkwifi_timeout = 0;
-  static ulong current_millis;
-  current_millis = millis();
+  unsigned long now = millis();
+  bool connected = WiFi.status() == WL_CONNECTED;
+  bool lost = wifiLinkLost;
+  wifiLinkLost = false;
 
-  // Check WiFi every WIFICHECK_INTERVAL (1) seconds.
-  if ((current_millis > checkwifi_timeout) || (checkwifi_timeout == 0))
+  switch (wifiLinkState)
   {
-    check_WiFi();
-    checkwifi_timeout = current_millis + WIFICHECK_INTERVAL;
+    case WIFI_LINK_CONNECTED:
+      if (lost || !connected) {
+#if DEBUG_TCP_BRIDGE
+        Serial.println(F("\nWiFi lost, reconnecting in the background"));
+#endif
+        wifiBackoffMs = WIFI_RECONNECT_MIN_BACKOFF_MS;
+        setWiFiLinkState(WIFI_LINK_BACKOFF);
+      }
+      break;
+
+    case WIFI_LINK_BACKOFF:
+      if (connected) {
+        setWiFiLinkState(WIFI_LINK_CONNECTED);
+      } else if (now - wifiLinkStateSince >= wifiBackoffMs) {
+        wifiReconnectAttempts++;
+        if (wifiFailedAttempts < WIFI_RECONNECT_SCAN_AFTER) {
+          WiFi.begin();
+          setWiFiLinkState(WIFI_LINK_CONNECTING);
+        } else {
+          wifiFailedAttempts = 0;
+          // the pinned attempt may still be running in the driver, and it would fail the scan
+          WiFi.disconnect();
+          // a scan that did not start reports WIFI_SCAN_FAILED on the next poll
+          WiFi.scanNetworks(true);
+          setWiFiLinkState(WIFI_LINK_SCANNING);
+        }
+      }
+      break;
+
+    case WIFI_LINK_SCANNING:
+    {
+      // the disconnect above raises lost too, so only the scan result counts here
+      int16_t found = WiFi.scanComplete();
+      if (found == WIFI_SCAN_RUNNING && now - wifiLinkStateSince < WIFI_RECONNECT_SCAN_MS) {
+        break;
+      }
+      beginAfterScan(found);
+      setWiFiLinkState(WIFI_LINK_CONNECTING);
+      break;
+    }
+
+    case WIFI_LINK_CONNECTING:
+      if (connected) {
+        wifiReconnects++;
+        wifiFailedAttempts = 0;
+        wifiBackoffMs = WIFI_RECONNECT_MIN_BACKOFF_MS;
+        setWiFiLinkState(WIFI_LINK_CONNECTED);
+        LOGERROR3(F("WiFi reconnected after attempts: "), wifiReconnectAttempts, F(", IP address:"), WiFi.localIP());
+      } else if (lost || now - wifiLinkStateSince >= WIFI_RECONNECT_ATTEMPT_MS) {
+        // failed attempt: wait twice as long before the next one
+        wifiFailedAttempts++;
+        wifiBackoffMs *= 2;
+        if (wifiBackoffMs > WIFI_RECONNECT_MAX_BACKOFF_MS) {
+          wifiBackoffMs = WIFI_RECONNECT_MAX_BACKOFF_MS;
+        }
+        setWiFiLinkState(WIFI_LINK_BACKOFF);
+      }
+      break;
   }
 }
 
@@ -200,11 +364,18 @@ bool loadConfigData()
 
   memset((void *) &WM_config,       0, sizeof(WM_config));
   memset((void *) &WM_STA_IPconfig, 0, sizeof(WM_STA_IPconfig));
+  memset((void *) &WM_fastConnect,  0, sizeof(WM_fastConnect));
 
   if (file)
   {
     file.readBytes((char *) &WM_config,   sizeof(WM_config));
     file.readBytes((char *) &WM_STA_IPconfig, sizeof(WM_STA_IPconfig));
+    // files written before the cache existed end here
+    if ( (file.readBytes((char *) &WM_fastConnect, sizeof(WM_fastConnect)) != sizeof(WM_fastConnect)) ||
+         (WM_fastConnect.checksum != calcChecksum( (uint8_t*) &WM_fastConnect, sizeof(WM_fastConnect) - sizeof(WM_fastConnect.checksum) )) )
+    {
+      memset((void *) &WM_fastConnect, 0, sizeof(WM_fastConnect));
+    }
 
     file.close();
     LOGERROR(F("OK"));
@@ -231,9 +402,11 @@ void saveConfigData()
   if (file)
   {
     WM_config.checksum = calcChecksum( (uint8_t*) &WM_config, sizeof(WM_config) - sizeof(WM_config.checksum) );
+    WM_fastConnect.checksum = calcChecksum( (uint8_t*) &WM_fastConnect, sizeof(WM_fastConnect) - sizeof(WM_fastConnect.checksum) );
 
     file.write((uint8_t*) &WM_config, sizeof(WM_config));
     file.write((uint8_t*) &WM_STA_IPconfig, sizeof(WM_STA_IPconfig));
+    file.write((uint8_t*) &WM_fastConnect, sizeof(WM_fastConnect));
     file.close();
     LOGERROR(F("OK"));
   }
@@ -242,6 +415,57 @@ void saveConfigData()
     LOGERROR(F("failed"));
   }
 }
+
+// Direct connect to the cached AP on the cached channel, skipping the scan; the
+//  address still comes from DHCP. false sends the caller to the full path
+bool tryFastConnect()
+{
+  if ( (WM_fastConnect.channel <= 0) || (WM_config.WiFi_Creds[0].wifi_ssid[0] == 0) )
+  {
+    return false;
+  }
+
+  WiFi.mode(WIFI_STA);
+  WiFi.begin(WM_config.WiFi_Creds[0].wifi_ssid, WM_config.WiFi_Creds[0].wifi_pw, WM_fastConnect.channel, WM_fastConnect.bssid);
+
+  unsigned long startedAt = millis();
+  while ( (WiFi.status() != WL_CONNECTED) && (millis() - startedAt < WIFI_FAST_CONNECT_TIMEOUT_MS) )
+  {
+    delay(10);
+  }
+
+  if (WiFi.status() == WL_CONNECTED)
+  {
+    LOGERROR1(F("Fast connect with cached BSSID/channel in ms: "), millis() - startedAt);
+    return true;
+  }
+
+  // stale cache: the full path scans again
+  LOGERROR(F("Fast connect failed"));
+  WiFi.disconnect();
+  return false;
+}
+
+// Stores the current association for the next boot, only when it changed
+void updateFastConnectCache()
+{
+  if (WiFi.status() != WL_CONNECTED)
+  {
+    return;
+  }
+
+  WiFi_FastConnect current;
+  memset((void *) &current, 0, sizeof(current));
+  memcpy(current.bssid, WiFi.BSSID(), sizeof(current.bssid));
+  current.channel = WiFi.channel();
+  current.checksum = calcChecksum( (uint8_t*) &current, sizeof(current) - sizeof(current.checksum) );
+
+  if (memcmp(&current, &WM_fastConnect, sizeof(current)) != 0)
+  {
+    WM_fastConnect = current;
+    saveConfigData();
+  }
+}
 #endif
 
 static void handleError(void* arg, AsyncClient* client, int8_t error) {
@@ -284,7 +508,9 @@ public:
     this->gfx = gfx;
     this->outgoingStream = outgoingStream;
     this->incomingStream = incomingStream;
+    unsigned long setupStartedAt = millis();
     unsigned long startedAt = millis();
+    bool fastConnected = false;
 
 #if USE_HARDCODED_CREDENTIALS
 #else
@@ -440,6 +666,11 @@ public:
         wifiMulti.addAP(WM_config.WiFi_Creds[i].wifi_ssid, WM_config.WiFi_Creds[i].wifi_pw);
       }
 
+      if ( WiFi.status() != WL_CONNECTED )
+      {
+        fastConnected = tryFastConnect();
+      }
+
       if ( WiFi.status() != WL_CONNECTED )
       {
   #if DEBUG_TCP_BRIDGE
@@ -448,6 +679,8 @@ public:
         connectMultiWiFi();
       }
     }
+
+    updateFastConnectCache();
 #endif
 
 #if DEBUG_TCP_BRIDGE
@@ -465,6 +698,8 @@ public:
       Serial.println(WiFi.status());
     }
 #endif
+    beginWiFiReconnect();
+
     clearTerminal(this->gfx);
     terminalPrintln("Connected, IP:", this->gfx);
     terminalPrintln(WiFi.localIP().toString(), this->gfx);
@@ -479,55 +714,101 @@ public:
       clients.push_back(client);
       
       // register events
+      client->onAck([this](void* arg, AsyncClient* client, size_t len, uint32_t time){
+        this->bytesSent += len;
 #if DEBUG_TCP_BRIDGE
-      client->onAck([&](void* arg, AsyncClient* client, size_t len, uint32_t time){ Serial.printf("\n ack: %d %d\n", len, time); }, NULL);
+        Serial.printf("\n ack: %d %d\n", len, time);
 #endif
+      }, NULL);
       client->onData([&](void* arg, AsyncClient* client, void *data, size_t len){ this->handleData(arg, client, data, len); }, NULL);
       client->onError(&handleError, NULL);
       client->onDisconnect(&handleDisconnect, NULL);
       client->onTimeout(&handleTimeOut, NULL);
     }, &server);
     server.begin();
+
+    // boot cost of the whole WiFi path, from setup() to a listening server
+    unsigned long timeToListening = millis() - setupStartedAt;
+#if DEBUG_TCP_BRIDGE
+    Serial.printf("TCP bridge listening after %lu ms (%s)\n", timeToListening, fastConnected ? "fast connect" : "full connect");
+#endif
+    terminalPrintln(String("Listening after ") + timeToListening + " ms" + (fastConnected ? " (fast)" : ""), this->gfx);
+
+#if UDP_TELEMETRY_ENABLED
+    if (!udpTelemetry.begin(UDP_TELEMETRY_PORT)) {
+      terminalPrintln("UDP telemetry port unavailable", this->gfx);
+    }
+#endif
   }
   
   void loop() {
     // put your main code here, to run repeatedly
     check_status();
     this->flush();
+
+#if UDP_TELEMETRY_ENABLED && DEBUG_TCP_BRIDGE
+    static unsigned long lastTelemetryStats = 0;
+    if (millis() - lastTelemetryStats >= 1000) {
+      lastTelemetryStats = millis();
+      UdpTelemetryStats stats = udpTelemetry.getStats();
+      Serial.printf("udp: %u frames, %u stale, %u superseded, %u lost, jitter %u us (stream %u us)\n",
+        stats.received, stats.stale, stats.superseded, stats.lost, stats.udpJitterUs, stats.streamJitterUs);
+    }
+#endif
   }
 
   void flush() {
     // if there is data available in the wifi stream, it's meant
     //  to go from Serial port to TCP client
-    size_t availableLength = this->outgoingStream->available();
-    if (availableLength)
-    {
-#if DEBUG_TCP_BRIDGE
-    Serial.printf("flushing with this much data: %d \n", availableLength);
-#endif
-      if (clients.size() == 0) {
-        // no clients to flush to
-        return;
-      }
+    if (this->outgoingStream->available() == 0 || clients.size() == 0) {
+      // nothing to send, or no clients to flush to (data waits in the stream)
+      return;
+    }
 
-      // read the available data from the stream, and put in in the buffer
-      char sbuf[availableLength];
-      this->outgoingStream->readBytes(sbuf, availableLength);
+    AsyncClient* client = clients.front();
+    if (!client->connected()) {
+      return;
+    }
 
-      // if TCP client is available
-      AsyncClient* client = clients.front();
-      if (client->connected())
-      {
-        // send data to client
-        size_t total = client->write(sbuf, availableLength);
+    // hand the ring segments straight to the TCP stack, as much as its send
+    //  buffer takes; whatever doesn't fit stays in the stream for the next flush
+    size_t queued = 0;
+    const uint8_t *data;
+    size_t length;
+    while ((length = this->outgoingStream->peekContiguous(&data)) > 0) {
+      size_t room = client->space();
+      if (room == 0) {
+        break;
+      }
+      size_t accepted = client->add((const char*)data, length < room ? length : room);
+      if (accepted == 0) {
+        break;
+      }
+      this->outgoingStream->consume(accepted);
+      queued += accepted;
+    }
+
+    if (queued) {
+      this->bytesQueued += queued;
+      client->send();
 #if DEBUG_TCP_BRIDGE
-	  Serial.printf("\n ---> data sent to client %s: %d bytes \n", client->remoteIP().toString().c_str(), total);
-    Serial.printf("%d %d\n",sbuf[0], sbuf[1]);
+      Serial.printf("\n ---> data queued to client %s: %d bytes, %d left \n", client->remoteIP().toString().c_str(), queued, this->outgoingStream->available());
 #endif
-      }
     }
   }
 
+  // Bytes handed to the TCP stack and bytes acknowledged by the client
+  uint32_t getBytesQueued() { return bytesQueued; }
+  uint32_t getBytesSent() { return bytesSent; }
+  // Bytes still waiting in the outgoing stream for send buffer space
+  size_t getBytesPending() { return this->outgoingStream->available(); }
+  // Bytes received while the incoming stream was full
+  uint32_t getBytesDropped() { return this->incomingStream->getOverflowBytes(); }
+  // Background WiFi reconnection: attempts made and links brought back
+  uint32_t getWiFiReconnectAttempts() { return wifiReconnectAttempts; }
+  uint32_t getWiFiReconnects() { return wifiReconnects; }
+  bool isWiFiUp() { return wifiLinkState == WIFI_LINK_CONNECTED; }
+
 private:
   void handleData(void* arg, AsyncClient* client, void *data, size_t len) {
 #if DEBUG_TCP_BRIDGE
@@ -535,13 +816,23 @@ private:
 	  Serial.write((uint8_t*)data, len);
     Serial.println(" ");
 #endif
+    // runs on the AsyncTCP task; the stream is a lock-free SPSC ring read by the loop
     const uint8_t *castData = (uint8_t*)data;
+#if DEBUG_TCP_BRIDGE
+    size_t written = this->incomingStream->write(castData, (size_t)len);
+    if (written < len) {
+      Serial.printf("\n incoming stream full, dropped %d bytes \n", len - written);
+    }
+#else
     this->incomingStream->write(castData, (size_t)len);
+#endif
   }
 
   AsyncServer server;
   FullLoopbackStream *incomingStream;
   FullLoopbackStream *outgoingStream;
+  uint32_t bytesQueued = 0;
+  uint32_t bytesSent = 0;
 
   Arduino_GFX *gfx;
 };
@@ -0,0 +1,128 @@
+#pragma once
+
+#include <Arduino.h>
+
+// Newest-wins slot behind the UDP telemetry path, kept free of the network and
+//  RTOS code so the same logic runs in the native tests (test/test_udp_telemetry).
+//  Callers serialize access: UdpTelemetry holds its lock around every call.
+//
+// Datagram layout: 4-byte little-endian sequence number, then the same text the
+//  custom protocol sends over the stream ("speed;gear;rpm%;...\n").
+//
+// Only the newest frame is kept: a frame arriving before the previous one was
+//  consumed replaces it, and frames with an older sequence number are dropped.
+#define UDP_TELEMETRY_HEADER_SIZE   4
+#define UDP_TELEMETRY_MAX_FRAME     512
+// while UDP frames keep coming, the stream copies of the telemetry are ignored
+#define UDP_TELEMETRY_HOLD_MS       500
+// a jump back larger than this is a restarted sender, not a late frame
+#define UDP_TELEMETRY_RESTART_GAP   1024
+
+// Smoothed inter-arrival jitter, as in RFC 3550: J += (|D| - J) / 16
+class FrameJitter
+{
+public:
+  void mark(uint32_t nowUs) {
+    if (lastUs) {
+      uint32_t interval = nowUs - lastUs;
+      if (lastInterval) {
+        int32_t delta = (int32_t)(interval - lastInterval);
+        uint32_t deviation = delta < 0 ? -delta : delta;
+        jitterQ4 += deviation - (jitterQ4 >> 4);
+      }
+      lastInterval = interval;
+    }
+    lastUs = nowUs;
+  }
+
+  uint32_t getJitterUs() const { return jitterQ4 >> 4; }
+
+private:
+  uint32_t lastUs = 0;
+  uint32_t lastInterval = 0;
+  uint32_t jitterQ4 = 0;
+};
+
+struct UdpTelemetryStats {
+  uint32_t received;        // frames accepted
+  uint32_t stale;           // older than the newest one seen, dropped
+  uint32_t superseded;      // replaced by a newer frame before being consumed
+  uint32_t lost;            // gaps in the sequence numbers
+  uint32_t udpJitterUs;     // jitter of UDP frames
+  uint32_t streamJitterUs;  // jitter of the telemetry frames that came over the stream
+};
+
+class TelemetrySlot
+{
+public:
+  // One datagram, header included; returns false when it was malformed or stale
+  bool offer(const uint8_t *data, size_t length, uint32_t nowMs, uint32_t nowUs) {
+    if (length <= UDP_TELEMETRY_HEADER_SIZE || length - UDP_TELEMETRY_HEADER_SIZE > UDP_TELEMETRY_MAX_FRAME) {
+      return false;
+    }
+    uint32_t sequence = data[0] | (data[1] << 8) | (data[2] << 16) | ((uint32_t)data[3] << 24);
+
+    if (stats.received) {
+      int32_t ahead = (int32_t)(sequence - lastSequence);
+      if (ahead <= 0 && ahead > -UDP_TELEMETRY_RESTART_GAP) {
+        stats.stale++;
+        return false;
+      }
+      if (ahead > 1 && ahead < UDP_TELEMETRY_RESTART_GAP) {
+        stats.lost += ahead - 1;
+      }
+    }
+    if (pending) {
+      stats.superseded++;
+    }
+    frameLength = length - UDP_TELEMETRY_HEADER_SIZE;
+    memcpy(frame, data + UDP_TELEMETRY_HEADER_SIZE, frameLength);
+    pending = true;
+    lastSequence = sequence;
+    lastPacketMs = nowMs;
+    stats.received++;
+    udpJitter.mark(nowUs);
+    return true;
+  }
+
+  // Copies the newest unread frame into buffer; returns its length, 0 if there is none
+  size_t take(char *buffer, size_t size) {
+    if (!pending) {
+      return 0;
+    }
+    size_t length = frameLength < size ? frameLength : size;
+    memcpy(buffer, frame, length);
+    pending = false;
+    return length;
+  }
+
+  // UDP frames arrived recently, so they take precedence over the stream
+  bool isActive(uint32_t nowMs) const {
+    return stats.received && nowMs - lastPacketMs < UDP_TELEMETRY_HOLD_MS;
+  }
+
+  // Called for each telemetry frame that came over the stream instead;
+  //  returns false when the UDP channel is live and the frame should be ignored
+  bool acceptStreamFrame(uint32_t nowMs, uint32_t nowUs) {
+    streamJitter.mark(nowUs);
+    return !isActive(nowMs);
+  }
+
+  UdpTelemetryStats getStats() const {
+    UdpTelemetryStats copy = stats;
+    copy.udpJitterUs = udpJitter.getJitterUs();
+    copy.streamJitterUs = streamJitter.getJitterUs();
+    return copy;
+  }
+
+private:
+  char frame[UDP_TELEMETRY_MAX_FRAME];
+  size_t frameLength = 0;
+  bool pending = false;
+  uint32_t lastSequence = 0;
+  uint32_t lastPacketMs = 0;
+
+  UdpTelemetryStats stats = {};
+  FrameJitter udpJitter;
+  FrameJitter streamJitter;
+};
@@ -0,0 +1,70 @@
+#pragma once
+
+#include <Arduino.h>
+#include <AsyncUDP.h>
+#include "Config.h"
+#include "TelemetrySlot.h"
+
+// Optional fast path for display/LED telemetry next to the TCP bridge.
+//  TCP keeps the handshake and control traffic; telemetry frames can also come
+//  over UDP, where a lost datagram never stalls the ones behind it.
+//  tools/udp_telemetry_sender.py feeds it from a PC; the frame handling itself
+//  lives in TelemetrySlot.h.
+class UdpTelemetry
+{
+public:
+  bool begin(uint16_t port) {
+    if (!udp.listen(port)) {
+      return false;
+    }
+    udp.onPacket([this](AsyncUDPPacket packet) { this->handlePacket(packet); });
+    return true;
+  }
+
+  // Copies the newest unread frame into buffer; returns its length, 0 if there is none
+  size_t take(char *buffer, size_t size) {
+    portENTER_CRITICAL(&lock);
+    size_t length = slot.take(buffer, size);
+    portEXIT_CRITICAL(&lock);
+    return length;
+  }
+
+  // UDP frames arrived recently, so they take precedence over the stream
+  bool isActive() {
+    portENTER_CRITICAL(&lock);
+    bool active = slot.isActive(millis());
+    portEXIT_CRITICAL(&lock);
+    return active;
+  }
+
+  // Called for each telemetry frame that came over the stream instead;
+  //  returns false when the UDP channel is live and the frame should be ignored
+  bool acceptStreamFrame() {
+    portENTER_CRITICAL(&lock);
+    bool accepted = slot.acceptStreamFrame(millis(), micros());
+    portEXIT_CRITICAL(&lock);
+    return accepted;
+  }
+
+  UdpTelemetryStats getStats() {
+    portENTER_CRITICAL(&lock);
+    UdpTelemetryStats copy = slot.getStats();
+    portEXIT_CRITICAL(&lock);
+    return copy;
+  }
+
+private:
+  // Runs in the AsyncUDP task
+  void handlePacket(AsyncUDPPacket &packet) {
+    portENTER_CRITICAL(&lock);
+    slot.offer(packet.data(), packet.length(), millis(), micros());
+    portEXIT_CRITICAL(&lock);
+  }
+
+  AsyncUDP udp;
+  portMUX_TYPE lock = portMUX_INITIALIZER_UNLOCKED;
+  TelemetrySlot slot;
+};
+
+// single instance: fed by the bridge's WiFi, consumed by the custom protocol
+UdpTelemetry udpTelemetry;
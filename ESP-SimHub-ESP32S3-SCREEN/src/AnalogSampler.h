@@ -0,0 +1,183 @@
+#pragma once
+#include <Arduino.h>
+#include <atomic>
+#include <driver/adc.h>
+
+/*
+ * AMOSTRAGEM CONTÍNUA DOS ADCs
+ * ----------------------------
+ * Joystick e sensores Hall são amostrados em segundo plano, fora do loop do
+ * volante. Cada canal guarda as últimas ANALOG_AVERAGE_SAMPLES leituras num
+ * anel e publica a soma; o WheelController só lê o valor publicado, sem
+ * bloquear.
+ *
+ * Com todos os pinos no ADC1 o conversor roda em modo contínuo (DMA) e uma
+ * task só desempacota os quadros. O modo contínuo do ESP32-S3 não funciona
+ * no ADC2, onde estão os pinos da fiação atual (GPIO 14, 15, 19 e 20), então
+ * nesse caso a mesma task faz leituras avulsas em rodadas, no core 0.
+ *
+ * Usa os pinos definidos no WheelController.h (JOY_X, JOY_Y, CLUTCH_LEFT,
+ * CLUTCH_RIGHT).
+ */
+
+#define ANALOG_AVERAGE_SAMPLES   4       // Leituras somadas por canal (potência de 2)
+#define ANALOG_DMA_RATE_HZ       20000   // Conversões por segundo no modo contínuo (todos os canais)
+#define ANALOG_DMA_FRAME_BYTES   256     // Bytes entregues por leitura do DMA
+#define ANALOG_POLL_ROUNDS       4       // Rodadas de leitura avulsa por tick no modo sem DMA
+#define ANALOG_TASK_CORE         0
+#define ANALOG_TASK_PRIORITY     2
+#define ANALOG_TASK_STACK        3072
+
+enum AnalogInput : uint8_t {
+    ANALOG_JOY_X,
+    ANALOG_JOY_Y,
+    ANALOG_CLUTCH_LEFT,
+    ANALOG_CLUTCH_RIGHT,
+    ANALOG_INPUT_COUNT
+};
+
+class AnalogSampler {
+private:
+    uint8_t pins[ANALOG_INPUT_COUNT] = {JOY_X, JOY_Y, CLUTCH_LEFT, CLUTCH_RIGHT};
+    int8_t adcChannel[ANALOG_INPUT_COUNT];    // Canal do ADC1, -1 se não for ADC1
+
+    // Só a task escreve
+    uint16_t ring[ANALOG_INPUT_COUNT][ANALOG_AVERAGE_SAMPLES];
+    uint8_t ringIndex[ANALOG_INPUT_COUNT];
+    uint32_t ringSum[ANALOG_INPUT_COUNT];
+
+    // Publicado para o loop do volante
+    std::atomic<uint32_t> sums[ANALOG_INPUT_COUNT];
+    std::atomic<uint32_t> sampleCount;
+
+    TaskHandle_t task;
+    bool dma;
+
+    void push(uint8_t input, uint16_t value) {
+        uint8_t i = ringIndex[input];
+        ringSum[input] += value - ring[input][i];
+        ring[input][i] = value;
+        ringIndex[input] = (i + 1) & (ANALOG_AVERAGE_SAMPLES - 1);
+        sums[input].store(ringSum[input], std::memory_order_release);
+    }
+
+    bool beginDma() {
+        uint32_t mask = 0;
+        adc_digi_pattern_config_t pattern[ANALOG_INPUT_COUNT];
+        for (int i = 0; i < ANALOG_INPUT_COUNT; i++) {
+            if (adcChannel[i] < 0) return false;
+            mask |= 1 << adcChannel[i];
+            pattern[i].atten = ADC_ATTEN_DB_11;
+            pattern[i].channel = adcChannel[i];
+            pattern[i].unit = 0;   // ADC1
+            pattern[i].bit_width = SOC_ADC_DIGI_MAX_BITWIDTH;
+        }
+
+        adc_digi_init_config_t init = {};
+        init.max_store_buf_size = ANALOG_DMA_FRAME_BYTES * 4;
+        init.conv_num_each_intr = ANALOG_DMA_FRAME_BYTES;
+        init.adc1_chan_mask = mask;
+        init.adc2_chan_mask = 0;
+        if (adc_digi_initialize(&init) != ESP_OK) return false;
+
+        adc_digi_configuration_t config = {};
+        config.conv_limit_en = false;
+        config.pattern_num = ANALOG_INPUT_COUNT;
+        config.adc_pattern = pattern;
+        config.sample_freq_hz = ANALOG_DMA_RATE_HZ;
+        config.conv_mode = ADC_CONV_SINGLE_UNIT_1;
+        config.format = ADC_DIGI_OUTPUT_FORMAT_TYPE2;
+        if (adc_digi_controller_configure(&config) != ESP_OK || adc_digi_start() != ESP_OK) {
+            adc_digi_deinitialize();
+            return false;
+        }
+        return true;
+    }
+
+    // Modo contínuo: bloqueia até o DMA entregar um quadro
+    void dmaLoop() {
+        uint8_t frame[ANALOG_DMA_FRAME_BYTES];
+        for (;;) {
+            uint32_t length = 0;
+            if (adc_digi_read_bytes(frame, sizeof(frame), &length, portMAX_DELAY) != ESP_OK) {
+                continue;
+            }
+            for (uint32_t offset = 0; offset + SOC_ADC_DIGI_RESULT_BYTES <= length; offset += SOC_ADC_DIGI_RESULT_BYTES) {
+                adc_digi_output_data_t* result = (adc_digi_output_data_t*)&frame[offset];
+                for (int i = 0; i < ANALOG_INPUT_COUNT; i++) {
+                    if (adcChannel[i] == result->type2.channel) {
+                        push(i, result->type2.data);
+                        break;
+                    }
+                }
+            }
+            sampleCount.fetch_add(length / SOC_ADC_DIGI_RESULT_BYTES, std::memory_order_relaxed);
+        }
+    }
+
+    // Sem DMA: rodadas de analogRead e cede o core até o próximo tick
+    void pollLoop() {
+        for (;;) {
+            for (int round = 0; round < ANALOG_POLL_ROUNDS; round++) {
+                for (int i = 0; i < ANALOG_INPUT_COUNT; i++) {
+                    push(i, analogRead(pins[i]));
+                }
+            }
+            sampleCount.fetch_add(ANALOG_POLL_ROUNDS * ANALOG_INPUT_COUNT, std::memory_order_relaxed);
+            vTaskDelay(1);
+        }
+    }
+
+    static void taskEntry(void* arg) {
+        AnalogSampler* self = (AnalogSampler*)arg;
+        if (self->dma) self->dmaLoop();
+        else self->pollLoop();
+    }
+
+public:
+    AnalogSampler() : sampleCount(0), task(nullptr), dma(false) {
+        memset(ring, 0, sizeof(ring));
+        memset(ringIndex, 0, sizeof(ringIndex));
+        memset(ringSum, 0, sizeof(ringSum));
+        for (int i = 0; i < ANALOG_INPUT_COUNT; i++) {
+            sums[i].store(0, std::memory_order_relaxed);
+        }
+    }
+
+    void begin() {
+        for (int i = 0; i < ANALOG_INPUT_COUNT; i++) {
+            int8_t channel = digitalPinToAnalogChannel(pins[i]);
+            // Canais do ADC2 vêm depois dos do ADC1 na numeração do Arduino
+            adcChannel[i] = (channel >= 0 && channel < SOC_ADC_CHANNEL_NUM(0)) ? channel : -1;
+        }
+
+        // Enche o anel antes de publicar, para não começar em zero
+        for (int n = 0; n < ANALOG_AVERAGE_SAMPLES; n++) {
+            for (int i = 0; i < ANALOG_INPUT_COUNT; i++) {
+                push(i, analogRead(pins[i]));
+            }
+        }
+
+        dma = beginDma();
+        xTaskCreatePinnedToCore(taskEntry, "analog", ANALOG_TASK_STACK, this,
+                                ANALOG_TASK_PRIORITY, &task, ANALOG_TASK_CORE);
+    }
+
+    // Soma das últimas ANALOG_AVERAGE_SAMPLES leituras
+    uint32_t getSum(AnalogInput input) const {
+        return sums[input].load(std::memory_order_acquire);
+    }
+
+    // Média das últimas leituras, 12 bits
+    uint16_t get(AnalogInput input) const {
+        return getSum(input) / ANALOG_AVERAGE_SAMPLES;
+    }
+
+    uint32_t getSampleCount() const {
+        return sampleCount.load(std::memory_order_relaxed);
+    }
+
+    bool isUsingDma() const {
+        return dma;
+    }
+};
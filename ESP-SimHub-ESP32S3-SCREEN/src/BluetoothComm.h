@@ -4,27 +4,56 @@
 #include <BLEServer.h>
 #include <BLEUtils.h>
 #include <BLE2902.h>
+#include <SpscRingBuffer.h>
+#include <esp_gap_ble_api.h>
+#include "SharedBLEServer.h"
 
 #define SERVICE_UUID        "6E400001-B5A3-F393-E0A9-E50E24DCCA9E"
 #define CHARACTERISTIC_UUID_RX "6E400002-B5A3-F393-E0A9-E50E24DCCA9E"
 #define CHARACTERISTIC_UUID_TX "6E400003-B5A3-F393-E0A9-E50E24DCCA9E"
+#define BLE_RX_BUFFER_SIZE  2048
+#define BLE_TX_BUFFER_SIZE  4096
+#define BLE_MTU             247     // Maior MTU pedido na troca com o host
+#define BLE_DEFAULT_MTU     23      // Até a troca de MTU acontecer
+#define BLE_ATT_HEADER      3       // Opcode + handle de cada notificação
+#define BLE_DLE_OCTETS      251     // Data length extension (máximo do controlador)
+#define BLE_TX_CHUNKS_PER_CALL 4    // Notificações enviadas por chamada, para não travar o loop
+
+/*
+ * Throughput: no begin() o MTU local vai para 247; ao conectar pede DLE e
+ * PHY 2M (o host aceita se suportar). write() só enfileira; as notificações
+ * saem em pedaços de MTU - 3 bytes, até BLE_TX_CHUNKS_PER_CALL por chamada
+ * de write()/loop(), e o resto espera na fila.
+ */
 
 class BluetoothComm : public Communication {
 private:
     BLEServer* pServer;
     BLECharacteristic* pTxCharacteristic;
-    bool deviceConnected;
-    std::vector<uint8_t> rxBuffer;
+    BLE2902* pTxCccd;          // Host assinou as notificações de TX
+    bool deviceConnected;      // Alguma central conectada (pode ser só o gamepad)
+    uint32_t lastAdvertise;
+    SpscRingBuffer rxBuffer;   // Task do BLE escreve, loop principal lê
+    SpscRingBuffer txBuffer;   // Notificações aguardando envio
+    uint16_t mtu;
+    uint32_t txNotifications;
 
     class ServerCallbacks: public BLEServerCallbacks {
         BluetoothComm* comm;
     public:
         ServerCallbacks(BluetoothComm* c) : comm(c) {}
-        void onConnect(BLEServer* pServer) override {
+        void onConnect(BLEServer* pServer, esp_ble_gatts_cb_param_t* param) override {
             comm->deviceConnected = true;
+            comm->mtu = BLE_DEFAULT_MTU;
+            // Pedidos ao controlador; o host recusa o que não suportar
+            esp_ble_gap_set_pkt_data_len(param->connect.remote_bda, BLE_DLE_OCTETS);
+            esp_ble_gap_set_prefered_phy(param->connect.remote_bda, 0,
+                ESP_BLE_GAP_PHY_2M_PREF_MASK, ESP_BLE_GAP_PHY_2M_PREF_MASK, ESP_BLE_GAP_PHY_OPTIONS_NO_PREF);
         }
         void onDisconnect(BLEServer* pServer) override {
             comm->deviceConnected = false;
+            // A próxima central precisa assinar de novo para contar como link de dados
+            comm->pTxCccd->setNotifications(false);
         }
     };
 
@@ -35,27 +64,59 @@ private:
         void onWrite(BLECharacteristic* pCharacteristic) override {
             std::string value = pCharacteristic->getValue();
             if (value.length() > 0) {
-                for (int i = 0; i < value.length(); i++) {
-                    comm->rxBuffer.push_back(value[i]);
-                }
+                comm->rxBuffer.write((const uint8_t*)value.data(), value.length());
             }
         }
     };
 
+    // Conectado e com as notificações de TX assinadas: um host só com o
+    // gamepad BLE não conta como link de dados
+    bool isSubscribed() {
+        return deviceConnected && pTxCccd->getNotifications();
+    }
+
+    // Envia o que estiver na fila em notificações do tamanho do MTU negociado
+    void pumpTx() {
+        if (!isSubscribed()) {
+            txBuffer.clear();   // Nada do que ficou na fila vale para a próxima conexão
+            return;
+        }
+        uint16_t peerMtu = pServer->getPeerMTU(pServer->getConnId());
+        if (peerMtu) mtu = min(peerMtu, (uint16_t)BLE_MTU);
+
+        uint8_t chunk[BLE_MTU - BLE_ATT_HEADER];
+        size_t chunkSize = mtu - BLE_ATT_HEADER;
+        for (int i = 0; i < BLE_TX_CHUNKS_PER_CALL; i++) {
+            size_t n = txBuffer.read(chunk, chunkSize);
+            if (!n) break;
+            pTxCharacteristic->setValue(chunk, n);
+            pTxCharacteristic->notify();
+            txNotifications++;
+        }
+    }
+
 public:
-    BluetoothComm() : deviceConnected(false) {}
+    BluetoothComm() :
+        pTxCccd(nullptr),
+        deviceConnected(false),
+        lastAdvertise(0),
+        rxBuffer(BLE_RX_BUFFER_SIZE),
+        txBuffer(BLE_TX_BUFFER_SIZE),
+        mtu(BLE_DEFAULT_MTU),
+        txNotifications(0) {}
 
     void begin() override {
-        BLEDevice::init("SimHub Dashboard");
-        pServer = BLEDevice::createServer();
-        pServer->setCallbacks(new ServerCallbacks(this));
+        // Com o gamepad BLE o servidor já existe; os dois serviços dividem a conexão
+        pServer = sharedBleServer.get("SimHub Dashboard", new ServerCallbacks(this));
+        BLEDevice::setMTU(BLE_MTU);
 
         BLEService* pService = pServer->createService(SERVICE_UUID);
         pTxCharacteristic = pService->createCharacteristic(
             CHARACTERISTIC_UUID_TX,
             BLECharacteristic::PROPERTY_NOTIFY
         );
-        pTxCharacteristic->addDescriptor(new BLE2902());
+        pTxCccd = new BLE2902();
+        pTxCharacteristic->addDescriptor(pTxCccd);
 
         BLECharacteristic* pRxCharacteristic = pService->createCharacteristic(
             CHARACTERISTIC_UUID_RX,
@@ -64,39 +125,59 @@ public:
         pRxCharacteristic->setCallbacks(new CharacteristicCallbacks(this));
 
         pService->start();
-        pServer->getAdvertising()->start();
+        // UUID de 128 bits vai na resposta ao scan (SharedBLEServer.h)
+        sharedBleServer.addService(BLEUUID(SERVICE_UUID));
+        sharedBleServer.startAdvertising();
     }
 
+    // Sem bloquear: os outros transportes rodam no mesmo loop
     void loop() override {
-        if (!deviceConnected) {
+        if (!deviceConnected && millis() - lastAdvertise >= 500) {
+            lastAdvertise = millis();
             pServer->getAdvertising()->start();
-            delay(500);
         }
+        pumpTx();
     }
 
+    // Enfileira e já manda o que couber; retorno menor que size = fila cheia
     size_t write(const uint8_t* buffer, size_t size) override {
-        if (deviceConnected) {
-            pTxCharacteristic->setValue((uint8_t*)buffer, size);
-            pTxCharacteristic->notify();
-            return size;
-        }
-        return 0;
+        if (!isSubscribed()) return 0;
+        size_t queued = txBuffer.write(buffer, size);
+        pumpTx();
+        return queued;
     }
 
     size_t read(uint8_t* buffer, size_t size) override {
-        size_t read = 0;
-        while (!rxBuffer.empty() && read < size) {
-            buffer[read++] = rxBuffer.front();
-            rxBuffer.erase(rxBuffer.begin());
-        }
-        return read;
+        return rxBuffer.read(buffer, size);
     }
 
     bool isConnected() override {
-        return deviceConnected;
+        return isSubscribed();
     }
 
     const char* getName() override {
         return "Bluetooth";
     }
+
+    uint16_t getMtu() {
+        return mtu;
+    }
+
+    uint32_t getTxNotificationCount() {
+        return txNotifications;
+    }
+
+    // Bytes recusados com a fila de envio cheia
+    uint32_t getTxOverflowBytes() {
+        return txBuffer.getOverflowBytes();
+    }
+
+    // Bytes descartados com o buffer de recepção cheio
+    uint32_t getRxOverflowBytes() {
+        return rxBuffer.getOverflowBytes();
+    }
+
+    uint32_t getRxOverflowCount() {
+        return rxBuffer.getOverflowCount();
+    }
 }; 
\ No newline at end of file
@@ -0,0 +1,161 @@
+#pragma once
+#include <Arduino.h>
+
+/*
+ * PIPELINE DAS EMBREAGENS
+ * -----------------------
+ * Cada sensor Hall passa por:
+ *    1. Oversampling: soma de CLUTCH_OVERSAMPLE leituras (12 -> 14 bits)
+ *    2. Filtro IIR de primeira ordem em ponto fixo (alfa = 1/2^CLUTCH_IIR_SHIFT)
+ *    3. Calibração automática: mínimo/máximo aprendidos durante o uso,
+ *       normalizados para 0..CLUTCH_OUTPUT_MAX
+ *
+ * A curva do bite point é uma tabela de CLUTCH_LUT_SIZE + 1 pontos com
+ * interpolação linear entre eles. Divisões só acontecem quando a calibração
+ * ou o bite point mudam; o caminho de 1kHz é só soma, shift e multiplicação.
+ */
+
+#define CLUTCH_OVERSAMPLE      4      // Leituras somadas por amostra
+#define CLUTCH_IIR_SHIFT       2      // Alfa = 1/4 (~4ms de constante de tempo a 1kHz)
+#define CLUTCH_FRAC_BITS       8      // Bits fracionários do estado do filtro
+#define CLUTCH_MIN_SPAN        400    // Curso mínimo (14 bits) para considerar calibrado
+#define CLUTCH_DEADZONE        64     // Zona morta em cada extremo do curso (14 bits)
+#define CLUTCH_OUTPUT_MAX      4095
+#define CLUTCH_LUT_BITS        8
+#define CLUTCH_LUT_SIZE        (1 << CLUTCH_LUT_BITS)
+#define CLUTCH_LUT_SHIFT       (12 - CLUTCH_LUT_BITS)
+
+class ClutchChannel {
+private:
+    int32_t filtered;      // Q.CLUTCH_FRAC_BITS
+    int32_t minValue;
+    int32_t maxValue;
+    int32_t lowerEdge;     // Mínimo + zona morta
+    uint32_t scale;        // CLUTCH_OUTPUT_MAX / curso, em Q16
+    bool primed;
+    uint16_t output;
+
+    void updateScale() {
+        int32_t span = maxValue - minValue - 2 * CLUTCH_DEADZONE;
+        if (span < CLUTCH_MIN_SPAN) {
+            scale = 0;
+            return;
+        }
+        lowerEdge = minValue + CLUTCH_DEADZONE;
+        scale = ((uint32_t)CLUTCH_OUTPUT_MAX << 16) / span;
+    }
+
+public:
+    ClutchChannel() {
+        reset();
+    }
+
+    void reset() {
+        filtered = 0;
+        minValue = INT32_MAX;
+        maxValue = INT32_MIN;
+        lowerEdge = 0;
+        scale = 0;
+        primed = false;
+        output = 0;
+    }
+
+    // sum: soma de CLUTCH_OVERSAMPLE leituras de 12 bits
+    void update(int32_t sum) {
+        int32_t sample = sum << CLUTCH_FRAC_BITS;
+        if (!primed) {
+            filtered = sample;
+            primed = true;
+        } else {
+            filtered += (sample - filtered) >> CLUTCH_IIR_SHIFT;
+        }
+
+        int32_t value = filtered >> CLUTCH_FRAC_BITS;
+
+        // Aprende o curso conforme o pedal é usado
+        bool learned = false;
+        if (value < minValue) { minValue = value; learned = true; }
+        if (value > maxValue) { maxValue = value; learned = true; }
+        if (learned) updateScale();
+
+        if (scale == 0) {
+            output = 0;
+            return;
+        }
+        int32_t position = value - lowerEdge;
+        if (position <= 0) {
+            output = 0;
+            return;
+        }
+        uint32_t scaled = ((uint32_t)position * scale) >> 16;
+        output = scaled > CLUTCH_OUTPUT_MAX ? CLUTCH_OUTPUT_MAX : scaled;
+    }
+
+    uint16_t get() const { return output; }
+    bool isCalibrated() const { return scale != 0; }
+    int32_t getMin() const { return minValue; }
+    int32_t getMax() const { return maxValue; }
+};
+
+class ClutchPipeline {
+private:
+    ClutchChannel left;
+    ClutchChannel right;
+    uint16_t biteLut[CLUTCH_LUT_SIZE + 1];
+    uint8_t bitePercent;
+
+    // Abaixo do bite point a embreagem percorre a primeira metade da saída,
+    // acima dele a segunda: ajuste fino em volta do ponto de tração
+    void buildLut() {
+        uint32_t bite = (uint32_t)bitePercent * CLUTCH_LUT_SIZE / 100;
+        const uint32_t half = CLUTCH_OUTPUT_MAX / 2;
+        for (uint32_t i = 0; i <= CLUTCH_LUT_SIZE; i++) {
+            uint32_t value;
+            if (i < bite) {
+                value = i * half / bite;
+            } else if (bite < CLUTCH_LUT_SIZE) {
+                value = half + (i - bite) * (CLUTCH_OUTPUT_MAX - half) / (CLUTCH_LUT_SIZE - bite);
+            } else {
+                value = half;
+            }
+            biteLut[i] = value;
+        }
+    }
+
+public:
+    ClutchPipeline() : bitePercent(50) {
+        buildLut();
+    }
+
+    void update(int32_t leftSum, int32_t rightSum) {
+        left.update(leftSum);
+        right.update(rightSum);
+    }
+
+    void setBitePoint(uint8_t percent) {
+        if (percent > 100) percent = 100;
+        if (percent == bitePercent) return;
+        bitePercent = percent;
+        buildLut();
+    }
+
+    // Curva do bite point com interpolação entre os pontos da tabela
+    uint16_t applyBitePoint(uint16_t value) const {
+        if (value > CLUTCH_OUTPUT_MAX) value = CLUTCH_OUTPUT_MAX;
+        uint32_t index = value >> CLUTCH_LUT_SHIFT;
+        uint32_t frac = value & ((1 << CLUTCH_LUT_SHIFT) - 1);
+        int32_t a = biteLut[index];
+        int32_t b = biteLut[index + 1];
+        return a + (((b - a) * (int32_t)frac) >> CLUTCH_LUT_SHIFT);
+    }
+
+    void resetCalibration() {
+        left.reset();
+        right.reset();
+    }
+
+    uint16_t getLeft() const { return left.get(); }
+    uint16_t getRight() const { return right.get(); }
+    const ClutchChannel& getLeftChannel() const { return left; }
+    const ClutchChannel& getRightChannel() const { return right; }
+};
@@ -3,57 +3,185 @@
 #include "WifiComm.h"
 #include "UsbComm.h"
 #include "BluetoothComm.h"
+#include "Config.h"
 #include <Arduino_GFX_Library.h>
 
+/*
+ * Todos os transportes habilitados no Config.h (COMM_ENABLE_*) ficam ativos
+ * ao mesmo tempo. A cada loop cada link recebe uma nota de saúde:
+ *    - desconectado vale 0
+ *    - conectado soma COMM_SCORE_CONNECTED mais a prioridade (ordem USB,
+ *      WiFi, Bluetooth)
+ *    - dados recebidos nos últimos COMM_STALL_MS somam COMM_SCORE_RX
+ *    - falhas seguidas de escrita tiram COMM_SCORE_TX_ERROR cada
+ *
+ * O tráfego segue o link de maior nota. Quando o ativo trava e o SimHub
+ * passa a falar por outro, a troca acontece no mesmo loop, sem reiniciar
+ * nem refazer o handshake: os links em espera só são esvaziados (marcando
+ * atividade) e a camada ARQ reenvia o que se perder na troca.
+ */
+
+#define COMM_MAX_LINKS          3
+#define COMM_STALL_MS           200   // Sem dados por mais que isso, o link está parado
+#define COMM_SCORE_CONNECTED    10
+#define COMM_SCORE_RX           100
+#define COMM_SCORE_TX_ERROR     5
+#define COMM_MAX_TX_ERRORS      4
+
+struct LinkHealth {
+    uint32_t lastRxMs;
+    uint32_t rxBytes;
+    uint32_t txBytes;
+    uint32_t txErrors;
+    uint8_t consecutiveTxErrors;
+    uint8_t score;
+};
+
 class CommManager {
 private:
+    Communication* links[COMM_MAX_LINKS];
+    LinkHealth health[COMM_MAX_LINKS];
+    uint8_t linkCount;
     Communication* activeComm;
+    int8_t activeIndex;
+    uint32_t failovers;
     Arduino_GFX* display;
-    
-public:
-    CommManager(Arduino_GFX* gfx) : display(gfx), activeComm(nullptr) {}
-    
-    ~CommManager() {
-        if (activeComm) {
-            delete activeComm;
+
+    void addLink(Communication* link) {
+        if (linkCount >= COMM_MAX_LINKS) {
+            delete link;
+            return;
         }
+        memset(&health[linkCount], 0, sizeof(LinkHealth));
+        links[linkCount++] = link;
+        link->begin();
     }
 
-    void setup() {
-        // Tenta USB primeiro
-        activeComm = new UsbComm();
-        activeComm->begin();
-        
-        if (!activeComm->isConnected()) {
-            delete activeComm;
-            
-            // Tenta Bluetooth
-            activeComm = new BluetoothComm();
-            activeComm->begin();
-            
-            if (!activeComm->isConnected()) {
-                delete activeComm;
-                
-                // Por último, tenta WiFi
-                activeComm = new WifiComm(display);
-                activeComm->begin();
+    uint8_t scoreLink(uint8_t i, uint32_t now) {
+        if (!links[i]->isConnected()) return 0;
+        const LinkHealth& h = health[i];
+        int score = COMM_SCORE_CONNECTED + (linkCount - i);
+        if (h.rxBytes && now - h.lastRxMs < COMM_STALL_MS) score += COMM_SCORE_RX;
+        score -= h.consecutiveTxErrors * COMM_SCORE_TX_ERROR;
+        return score > 0 ? score : 1;
+    }
+
+    // Links em espera: descarta o que chegar, só para medir atividade
+    void drainStandby(uint8_t i, uint32_t now) {
+        uint8_t scratch[64];
+        size_t n;
+        while ((n = links[i]->read(scratch, sizeof(scratch))) > 0) {
+            health[i].rxBytes += n;
+            health[i].lastRxMs = now;
+        }
+    }
+
+    void selectActive(uint32_t now) {
+        int8_t best = -1;
+        for (uint8_t i = 0; i < linkCount; i++) {
+            health[i].score = scoreLink(i, now);
+            if (health[i].score && (best < 0 || health[i].score > health[best].score)) {
+                best = i;
             }
         }
+        if (best < 0 || best == activeIndex) return;
+        if (activeIndex >= 0 && health[best].score <= health[activeIndex].score) return;
 
-        if (display) {
+        if (activeIndex >= 0) failovers++;
+        activeIndex = best;
+        activeComm = links[best];
+        health[best].consecutiveTxErrors = 0;
+        showActive();
+    }
+
+    void showActive() {
+        if (display && activeComm) {
             display->setCursor(0, 0);
             display->print("Connected via: ");
             display->println(activeComm->getName());
         }
     }
-    
+
+public:
+    CommManager(Arduino_GFX* gfx) : linkCount(0), activeComm(nullptr), activeIndex(-1), failovers(0), display(gfx) {}
+
+    ~CommManager() {
+        for (uint8_t i = 0; i < linkCount; i++) {
+            delete links[i];
+        }
+    }
+
+    void setup() {
+        // Ordem de prioridade: USB, WiFi, Bluetooth
+#if COMM_ENABLE_USB
+        addLink(new UsbComm());
+#endif
+#if COMM_ENABLE_WIFI
+        addLink(new WifiComm(display));
+#endif
+#if COMM_ENABLE_BLUETOOTH
+        addLink(new BluetoothComm());
+#endif
+
+        selectActive(millis());
+        // Nenhum link conectado ainda: começa pelo de maior prioridade
+        if (!activeComm && linkCount) {
+            activeIndex = 0;
+            activeComm = links[0];
+            showActive();
+        }
+    }
+
     void loop() {
-        if (activeComm) {
-            activeComm->loop();
+        uint32_t now = millis();
+        for (uint8_t i = 0; i < linkCount; i++) {
+            links[i]->loop();
+            if (i != activeIndex) drainStandby(i, now);
+        }
+        selectActive(now);
+    }
+
+    size_t write(const uint8_t* buffer, size_t size) {
+        if (!activeComm) return 0;
+        size_t written = activeComm->write(buffer, size);
+        LinkHealth& h = health[activeIndex];
+        h.txBytes += written;
+        if (written < size) {
+            h.txErrors++;
+            if (h.consecutiveTxErrors < COMM_MAX_TX_ERRORS) h.consecutiveTxErrors++;
+        } else {
+            h.consecutiveTxErrors = 0;
+        }
+        return written;
+    }
+
+    size_t read(uint8_t* buffer, size_t size) {
+        if (!activeComm) return 0;
+        size_t n = activeComm->read(buffer, size);
+        if (n) {
+            health[activeIndex].rxBytes += n;
+            health[activeIndex].lastRxMs = millis();
         }
+        return n;
     }
 
     Communication* getCurrent() {
         return activeComm;
     }
-}; 
\ No newline at end of file
+
+    uint8_t getLinkCount() {
+        return linkCount;
+    }
+
+    Communication* getLink(uint8_t index) {
+        return index < linkCount ? links[index] : nullptr;
+    }
+
+    const LinkHealth& getHealth(uint8_t index) {
+        return health[index < linkCount ? index : 0];
+    }
+
+    uint32_t getFailoverCount() {
+        return failovers;
+    }
+};
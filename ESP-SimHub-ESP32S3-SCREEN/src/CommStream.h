@@ -0,0 +1,107 @@
+#pragma once
+#include <Arduino.h>
+#include "CommManager.h"
+
+/*
+ * Stream sobre o CommManager, para o ARQSerial/FlowSerial falar pelo
+ * transporte ativo (USB, WiFi ou Bluetooth) em vez do Serial fixo.
+ *
+ * Leitura: quando o buffer esvazia, um único read(buffer, size) em bloco no
+ * transporte enche o buffer; read()/available() do ARQ só consomem dele.
+ * Escrita: os bytes de um pacote ficam no buffer e saem num único
+ * write(buffer, size) no flush() que o ARQ já chama no fim de cada pacote.
+ */
+
+#define COMM_STREAM_RX_SIZE 256
+#define COMM_STREAM_TX_SIZE 128
+
+class CommStream : public Stream {
+private:
+    CommManager* manager;
+
+    uint8_t rxBuffer[COMM_STREAM_RX_SIZE];
+    size_t rxHead;
+    size_t rxCount;
+
+    uint8_t txBuffer[COMM_STREAM_TX_SIZE];
+    size_t txCount;
+
+    uint32_t bulkReads;
+    uint32_t bulkWrites;
+
+    bool fill() {
+        if (rxHead < rxCount) return true;
+        rxHead = 0;
+        rxCount = manager ? manager->read(rxBuffer, sizeof(rxBuffer)) : 0;
+        if (rxCount) bulkReads++;
+        return rxCount > 0;
+    }
+
+public:
+    using Print::write;
+
+    CommStream() : manager(nullptr), rxHead(0), rxCount(0), txCount(0), bulkReads(0), bulkWrites(0) {}
+
+    void begin(CommManager* commManager) {
+        manager = commManager;
+    }
+
+    int available() override {
+        fill();
+        return rxCount - rxHead;
+    }
+
+    int read() override {
+        if (!fill()) return -1;
+        return rxBuffer[rxHead++];
+    }
+
+    int peek() override {
+        if (!fill()) return -1;
+        return rxBuffer[rxHead];
+    }
+
+    size_t readBytes(char* buffer, size_t length) override {
+        size_t copied = 0;
+        while (copied < length && fill()) {
+            size_t n = min(length - copied, rxCount - rxHead);
+            memcpy(buffer + copied, rxBuffer + rxHead, n);
+            rxHead += n;
+            copied += n;
+        }
+        return copied;
+    }
+
+    size_t write(uint8_t data) override {
+        if (txCount >= sizeof(txBuffer)) flush();
+        txBuffer[txCount++] = data;
+        return 1;
+    }
+
+    size_t write(const uint8_t* buffer, size_t size) override {
+        size_t written = 0;
+        while (written < size) {
+            if (txCount >= sizeof(txBuffer)) flush();
+            size_t n = min(size - written, sizeof(txBuffer) - txCount);
+            memcpy(txBuffer + txCount, buffer + written, n);
+            txCount += n;
+            written += n;
+        }
+        return written;
+    }
+
+    void flush() override {
+        if (!txCount) return;
+        if (manager) manager->write(txBuffer, txCount);
+        txCount = 0;
+        bulkWrites++;
+    }
+
+    uint32_t getBulkReadCount() const {
+        return bulkReads;
+    }
+
+    uint32_t getBulkWriteCount() const {
+        return bulkWrites;
+    }
+};
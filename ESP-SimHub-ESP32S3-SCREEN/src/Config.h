@@ -2,6 +2,18 @@
 
 #define BRIDGE_PORT 10001
 #define DEBUG_TCP_BRIDGE false 
+// Buffers entre a task do AsyncTCP e o loop: a recepção fica na PSRAM para aguentar rajadas
+#define BRIDGE_RX_BUFFER_SIZE   32768
+#define BRIDGE_TX_BUFFER_SIZE   1024
+
+// Canal UDP opcional para a telemetria do display/LEDs (o TCP continua com o handshake)
+#define UDP_TELEMETRY_ENABLED   false
+#define UDP_TELEMETRY_PORT      10002
+
+// Transportes do CommManager, todos ativos ao mesmo tempo com failover
+#define COMM_ENABLE_USB         true
+#define COMM_ENABLE_BLUETOOTH   true
+#define COMM_ENABLE_WIFI        false  // Precisa de credenciais (portal do WiFiManager)
 
 // LED Configurations
 #define LED_PIN         21    // Pino que vai ao TXS0108E
@@ -32,6 +44,34 @@
 // #define PURPLE_FLAG_LED 23    // LED para setor mais rápido
 
 // Configuração de Brilho
-#define BRIGHTNESS_PIN   4     // Pino PWM para o MOSFET
+#define BRIGHTNESS_PIN   38    // Pino PWM para o MOSFET (livre: 2-5 são seleção dos MUX)
 #define MIN_BRIGHTNESS   0     // Brilho mínimo (0%)
-#define MAX_BRIGHTNESS   20    // Brilho máximo (100%) 
\ No newline at end of file
+#define MAX_BRIGHTNESS   20    // Brilho máximo (100%) 
+
+// Dimmer por hardware (LEDC) no BRIGHTNESS_PIN
+#define BRIGHTNESS_LEDC_CHANNEL 7      // Canal LEDC reservado para o MOSFET
+#define BRIGHTNESS_PWM_FREQ     20000  // 20kHz, fora da faixa audível
+#define BRIGHTNESS_PWM_BITS     10     // Resolução do duty (0-1023)
+#define BRIGHTNESS_FADE_MS      250    // Duração padrão do fade
+
+// Perfis de brilho (0-255, aplicados no MOSFET)
+#define BRIGHTNESS_DAY_MAX      255
+#define BRIGHTNESS_NIGHT_MIN    8
+#define BRIGHTNESS_NIGHT_MAX    64
+#define BRIGHTNESS_HYSTERESIS   8      // Ignora variações menores de luz ambiente
+
+// Sensor de luz ambiente opcional (LDR em divisor resistivo) para o perfil automático
+// #define AMBIENT_LIGHT_PIN    10
+#define AMBIENT_SAMPLE_MS       500
+
+// Gravação de quadros dos LEDs (fita + PCA9685) para exportação
+// #define LED_FRAME_RECORDER
+#define LED_RECORDER_FRAMES     256
+
+// Benchmark de LEDs no boot: reproduz telemetria sintética e imprime os custos na Serial
+// #define LED_BENCHMARK
+
+// Benchmark de latência paddle -> relatório HID, impresso na Serial a cada 500 medições
+// #define INPUT_LATENCY_BENCHMARK
+// Usa uma borda simulada (injetada na varredura) em vez da interrupção do paddle
+// #define INPUT_LATENCY_SIMULATE
\ No newline at end of file
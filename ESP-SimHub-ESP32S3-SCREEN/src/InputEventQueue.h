@@ -0,0 +1,112 @@
+#pragma once
+#include <Arduino.h>
+#include <atomic>
+
+/*
+ * FILA DE EVENTOS DE ENTRADA
+ * --------------------------
+ * Fila circular lock-free de um produtor e um consumidor (SPSC):
+ *    - Produtor: a varredura do MuxScanner (ISR do timer)
+ *    - Consumidor: o WheelController, que gera os relatórios HID
+ *
+ * Cada evento leva o micros() do momento em que foi amostrado. O consumidor
+ * mede a latência até retirar o evento da fila. Com a fila cheia o evento é
+ * descartado e o contador de overflow é incrementado.
+ */
+
+#define INPUT_QUEUE_SIZE 64   // Potência de 2
+
+enum InputEventType : uint8_t {
+    INPUT_EVENT_PRESS,
+    INPUT_EVENT_RELEASE,
+    INPUT_EVENT_ENCODER
+};
+
+// IDs dos botões nos eventos de PRESS/RELEASE
+#define INPUT_ID_MUX_BUTTON     0     // 0-15: canais do MUX2
+#define INPUT_ID_PADDLE_UP      16
+#define INPUT_ID_PADDLE_DOWN    17
+#define INPUT_ID_JOYSTICK       18
+#define INPUT_BUTTON_COUNT      19
+
+struct InputEvent {
+    uint32_t timestamp;   // micros() da amostra
+    InputEventType type;
+    uint8_t id;           // Botão (INPUT_ID_*) ou índice do encoder
+    int8_t delta;         // Encoders: detents girados (+/-)
+};
+
+struct InputLatencyStats {
+    uint32_t count;
+    uint32_t minUs;
+    uint32_t maxUs;
+    uint64_t totalUs;
+};
+
+class InputEventQueue {
+private:
+    InputEvent events[INPUT_QUEUE_SIZE];
+    std::atomic<uint32_t> head;   // Só o produtor escreve
+    std::atomic<uint32_t> tail;   // Só o consumidor escreve
+    volatile uint32_t overflows;
+
+    InputLatencyStats latency;
+
+public:
+    InputEventQueue() : head(0), tail(0), overflows(0) {
+        resetStats();
+    }
+
+    // Produtor
+    bool IRAM_ATTR push(const InputEvent& event) {
+        uint32_t h = head.load(std::memory_order_relaxed);
+        if (h - tail.load(std::memory_order_acquire) >= INPUT_QUEUE_SIZE) {
+            overflows++;
+            return false;
+        }
+        events[h & (INPUT_QUEUE_SIZE - 1)] = event;
+        head.store(h + 1, std::memory_order_release);
+        return true;
+    }
+
+    // Consumidor
+    bool pop(InputEvent& event) {
+        uint32_t t = tail.load(std::memory_order_relaxed);
+        if (t == head.load(std::memory_order_acquire)) {
+            return false;
+        }
+        event = events[t & (INPUT_QUEUE_SIZE - 1)];
+        tail.store(t + 1, std::memory_order_release);
+
+        uint32_t us = micros() - event.timestamp;
+        latency.count++;
+        latency.totalUs += us;
+        if (us < latency.minUs) latency.minUs = us;
+        if (us > latency.maxUs) latency.maxUs = us;
+        return true;
+    }
+
+    uint32_t size() const {
+        return head.load(std::memory_order_acquire) - tail.load(std::memory_order_acquire);
+    }
+
+    uint32_t getOverflowCount() const {
+        return overflows;
+    }
+
+    const InputLatencyStats& getLatencyStats() const {
+        return latency;
+    }
+
+    uint32_t getAverageLatencyUs() const {
+        return latency.count ? latency.totalUs / latency.count : 0;
+    }
+
+    void resetStats() {
+        latency.count = 0;
+        latency.minUs = UINT32_MAX;
+        latency.maxUs = 0;
+        latency.totalUs = 0;
+        overflows = 0;
+    }
+};
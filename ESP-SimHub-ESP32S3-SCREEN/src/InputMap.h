@@ -0,0 +1,152 @@
+#pragma once
+#include <Arduino.h>
+#include <Preferences.h>
+#include "InputEventQueue.h"
+#include "WheelHID.h"
+
+/*
+ * MAPEAMENTO DE ENTRADAS -> BOTÕES HID
+ * ------------------------------------
+ * Tabela densa indexada pelo ID da entrada: um acesso de array por evento.
+ *    - 0-18: botões (INPUT_ID_*)
+ *    - 19+2i / 20+2i: encoder i, horário / anti-horário
+ * O valor é o botão HID (0-47) ou INPUT_MAP_NONE para desativar a entrada.
+ * O padrão é a identidade, igual à numeração do WheelHID.
+ *
+ * A tabela fica no NVS (Preferences) e é carregada no boot. Alterações só
+ * marcam a tabela como suja; uma task de baixa prioridade no core 0 grava
+ * depois de INPUT_MAP_SAVE_DELAY_MS sem novas alterações, então uma
+ * sequência de edições vira uma única escrita na flash e o commit do NVS
+ * não roda no loop do HID. Durante o apagar/gravar da flash a cache fica
+ * desligada e os dois cores (e a interrupção da varredura, que não está
+ * registrada como IRAM) param por alguns ms; por isso a gravação só
+ * acontece depois que as edições param, nunca a cada alteração.
+ *
+ * Cada alteração incrementa a revisão; o WheelController usa isso para
+ * refazer os botões das entradas que estão pressionadas durante a troca.
+ *
+ * Editável pelo protocolo customizado do SimHub (SHCustomProtocol):
+ *    MAP;<entrada>;<botão>     ex.: MAP;16;0 (paddle + no botão 1)
+ *    MAP;<entrada>;-1          desativa a entrada
+ *    MAP;RESET                 volta ao padrão
+ */
+
+#define INPUT_MAP_SIZE            (INPUT_BUTTON_COUNT + NUM_ENCODERS * 2)
+#define INPUT_MAP_NONE            0xFF
+#define INPUT_MAP_SAVE_DELAY_MS   2000
+#define INPUT_MAP_NAMESPACE       "wheel"
+#define INPUT_MAP_KEY             "map"
+#define INPUT_MAP_TASK_STACK      3072
+#define INPUT_MAP_TASK_PRIORITY   1      // Acima só da idle
+#define INPUT_MAP_TASK_CORE       0      // Longe do loop do HID (core 1)
+#define INPUT_MAP_TASK_PERIOD_MS  100
+
+// ID de cada sentido de um encoder na tabela
+#define INPUT_MAP_ENCODER_CW(i)   (INPUT_BUTTON_COUNT + (i) * 2)
+#define INPUT_MAP_ENCODER_CCW(i)  (INPUT_BUTTON_COUNT + (i) * 2 + 1)
+
+class InputMap {
+private:
+    uint8_t table[INPUT_MAP_SIZE];
+    volatile bool dirty;
+    volatile uint32_t lastChange;
+    volatile uint32_t revision;
+    uint32_t saves;
+    TaskHandle_t task;
+    portMUX_TYPE lock = portMUX_INITIALIZER_UNLOCKED;  // Tabela: loop edita, task copia
+
+    void markChanged() {
+        dirty = true;
+        lastChange = millis();
+        revision++;
+    }
+
+    // Grava uma cópia, para a tabela continuar editável durante a escrita
+    void save() {
+        uint8_t copy[INPUT_MAP_SIZE];
+        portENTER_CRITICAL(&lock);
+        memcpy(copy, table, sizeof(copy));
+        dirty = false;
+        portEXIT_CRITICAL(&lock);
+
+        Preferences prefs;
+        if (!prefs.begin(INPUT_MAP_NAMESPACE, false)) return;
+        prefs.putBytes(INPUT_MAP_KEY, copy, sizeof(copy));
+        prefs.end();
+        saves++;
+    }
+
+    static void taskEntry(void* arg) {
+        InputMap* self = (InputMap*)arg;
+        for (;;) {
+            vTaskDelay(pdMS_TO_TICKS(INPUT_MAP_TASK_PERIOD_MS));
+            // Grava a tabela quando as edições param por INPUT_MAP_SAVE_DELAY_MS
+            if (self->dirty && millis() - self->lastChange >= INPUT_MAP_SAVE_DELAY_MS) {
+                self->save();
+            }
+        }
+    }
+
+public:
+    InputMap() : dirty(false), lastChange(0), revision(0), saves(0), task(nullptr) {
+        reset();
+        dirty = false;
+    }
+
+    // Tabela gravada com outro tamanho (firmware antigo) é ignorada
+    void begin() {
+        Preferences prefs;
+        if (prefs.begin(INPUT_MAP_NAMESPACE, true)) {
+            if (prefs.getBytesLength(INPUT_MAP_KEY) == sizeof(table)) {
+                prefs.getBytes(INPUT_MAP_KEY, table, sizeof(table));
+                revision++;
+            }
+            prefs.end();
+        }
+
+        if (!task) {
+            xTaskCreatePinnedToCore(taskEntry, "inputMap", INPUT_MAP_TASK_STACK, this,
+                                    INPUT_MAP_TASK_PRIORITY, &task, INPUT_MAP_TASK_CORE);
+        }
+    }
+
+    uint8_t get(uint8_t input) const {
+        return input < INPUT_MAP_SIZE ? table[input] : INPUT_MAP_NONE;
+    }
+
+    bool set(uint8_t input, uint8_t button) {
+        if (input >= INPUT_MAP_SIZE) return false;
+        if (button >= HID_BUTTON_COUNT) button = INPUT_MAP_NONE;
+        if (table[input] == button) return true;
+        portENTER_CRITICAL(&lock);
+        table[input] = button;
+        markChanged();
+        portEXIT_CRITICAL(&lock);
+        return true;
+    }
+
+    void reset() {
+        portENTER_CRITICAL(&lock);
+        for (uint8_t i = 0; i < INPUT_MAP_SIZE; i++) {
+            table[i] = i < HID_BUTTON_COUNT ? i : INPUT_MAP_NONE;
+        }
+        markChanged();
+        portEXIT_CRITICAL(&lock);
+    }
+
+    // Muda a cada alteração da tabela
+    uint32_t getRevision() const {
+        return revision;
+    }
+
+    bool isDirty() const {
+        return dirty;
+    }
+
+    uint32_t getSaveCount() const {
+        return saves;
+    }
+};
+
+// Instância única: usada pelo WheelController e pelo SHCustomProtocol
+InputMap inputMap;
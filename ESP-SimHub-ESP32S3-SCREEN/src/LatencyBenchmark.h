@@ -0,0 +1,140 @@
+#pragma once
+#include <Arduino.h>
+#include "InputEventQueue.h"
+#include "MuxScanner.h"
+
+/*
+ * BENCHMARK DE LATÊNCIA ENTRADA -> RELATÓRIO
+ * ------------------------------------------
+ * Ativado com INPUT_LATENCY_BENCHMARK no Config.h. Mede o tempo entre a
+ * borda do paddle e o momento em que o relatório com o pressionamento é
+ * entregue à pilha USB/BLE:
+ *    - borda real: interrupção de GPIO na descida do SHIFTER_UP
+ *    - borda simulada (INPUT_LATENCY_SIMULATE): a cada
+ *      LATENCY_BENCH_PERIOD_MS o botão é injetado na varredura do
+ *      MuxScanner, sem precisar apertar nada
+ *
+ * A cada LATENCY_BENCH_SAMPLES medições imprime na Serial mínimo, média,
+ * p99 e máximo, e o histograma em faixas de LATENCY_BENCH_BIN_US.
+ */
+
+#define LATENCY_BENCH_INPUT       INPUT_ID_PADDLE_UP
+#define LATENCY_BENCH_BIN_US      250
+#define LATENCY_BENCH_BINS        80       // Até 20ms (o debounce sozinho leva ~6ms); acima disso vai para a última faixa
+#define LATENCY_BENCH_SAMPLES     500
+#define LATENCY_BENCH_PERIOD_MS   40       // Ciclo pressiona/solta da borda simulada
+#define LATENCY_BENCH_TIMEOUT_US  100000   // Borda sem relatório depois disso é descartada
+
+class LatencyBenchmark;
+LatencyBenchmark* latencyBenchmarkInstance = nullptr;
+
+class LatencyBenchmark {
+private:
+    volatile uint32_t edgeUs;
+    volatile bool pending;
+    bool simulate;
+    bool simulatedPressed;
+    uint32_t lastToggle;
+
+    uint32_t histogram[LATENCY_BENCH_BINS + 1];
+    uint32_t count;
+    uint32_t minUs;
+    uint32_t maxUs;
+    uint64_t totalUs;
+
+    static void IRAM_ATTR onEdge() {
+        latencyBenchmarkInstance->markEdge(micros());
+    }
+
+    void record(uint32_t us) {
+        uint32_t bin = us / LATENCY_BENCH_BIN_US;
+        histogram[bin < LATENCY_BENCH_BINS ? bin : LATENCY_BENCH_BINS]++;
+        count++;
+        totalUs += us;
+        if (us < minUs) minUs = us;
+        if (us > maxUs) maxUs = us;
+    }
+
+    // Limite superior da faixa que contém o percentil
+    uint32_t percentile(uint32_t percent) const {
+        uint32_t target = (count * percent + 99) / 100;
+        uint32_t seen = 0;
+        for (int bin = 0; bin <= LATENCY_BENCH_BINS; bin++) {
+            seen += histogram[bin];
+            if (seen >= target) {
+                return bin < LATENCY_BENCH_BINS ? (bin + 1) * LATENCY_BENCH_BIN_US : maxUs;
+            }
+        }
+        return maxUs;
+    }
+
+public:
+    LatencyBenchmark() : edgeUs(0), pending(false), simulate(false), simulatedPressed(false), lastToggle(0) {
+        reset();
+    }
+
+    void begin() {
+        latencyBenchmarkInstance = this;
+#ifdef INPUT_LATENCY_SIMULATE
+        simulate = true;
+#else
+        attachInterrupt(digitalPinToInterrupt(SHIFTER_UP), &LatencyBenchmark::onEdge, FALLING);
+#endif
+    }
+
+    // Repiques da mesma borda não reiniciam a medição
+    void IRAM_ATTR markEdge(uint32_t us) {
+        if (pending && us - edgeUs < LATENCY_BENCH_TIMEOUT_US) return;
+        edgeUs = us;
+        pending = true;
+    }
+
+    // Chamado quando um relatório com LATENCY_BENCH_INPUT pressionado é entregue
+    void reportQueued() {
+        if (!pending) return;
+        uint32_t us = micros() - edgeUs;
+        pending = false;
+        if (us >= LATENCY_BENCH_TIMEOUT_US) return;
+
+        record(us);
+        if (count % LATENCY_BENCH_SAMPLES == 0) {
+            print(Serial);
+        }
+    }
+
+    // Borda simulada: injeta o botão direto na varredura
+    void loop(MuxScanner& scanner) {
+        if (!simulate) return;
+        uint32_t now = millis();
+        if (now - lastToggle < LATENCY_BENCH_PERIOD_MS / 2) return;
+        lastToggle = now;
+
+        simulatedPressed = !simulatedPressed;
+        if (simulatedPressed) markEdge(micros());
+        scanner.injectButtons(simulatedPressed ? 1UL << LATENCY_BENCH_INPUT : 0);
+    }
+
+    void reset() {
+        memset(histogram, 0, sizeof(histogram));
+        count = 0;
+        minUs = UINT32_MAX;
+        maxUs = 0;
+        totalUs = 0;
+    }
+
+    void print(Print& out) const {
+        if (count == 0) return;
+        out.println(F("=== Input latency ==="));
+        out.printf("%s edge, %u samples\n", simulate ? "simulated" : "gpio", count);
+        out.printf("min %u us, avg %u us, p99 <= %u us, max %u us\n",
+            minUs, (uint32_t)(totalUs / count), percentile(99), maxUs);
+        for (int bin = 0; bin <= LATENCY_BENCH_BINS; bin++) {
+            if (!histogram[bin]) continue;
+            if (bin < LATENCY_BENCH_BINS) {
+                out.printf("%5u-%5u us: %u\n", bin * LATENCY_BENCH_BIN_US, (bin + 1) * LATENCY_BENCH_BIN_US, histogram[bin]);
+            } else {
+                out.printf("  >= %5u us: %u\n", bin * LATENCY_BENCH_BIN_US, histogram[bin]);
+            }
+        }
+    }
+};
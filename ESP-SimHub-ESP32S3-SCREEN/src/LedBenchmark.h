@@ -0,0 +1,55 @@
+#pragma once
+#include <Arduino.h>
+#include "LedManager.h"
+#include "LedReplay.h"
+
+/*
+ * BENCHMARK DOS LEDS
+ * ------------------
+ * Ativado com LED_BENCHMARK no Config.h. No boot reproduz a telemetria
+ * sintética do LedReplay.h pelo LedManager e imprime na Serial:
+ *    - custo de cada atualização (média e máximo, em µs)
+ *    - quantos FastLED.show() foram enviados e quantos eram redundantes
+ *    - escritas I2C no PCA9685 por segundo, na taxa do loop do volante (100Hz)
+ *
+ * Com LED_FRAME_RECORDER ativo os quadros gravados são exportados no final.
+ */
+
+#define LED_BENCHMARK_FRAMES     LED_REPLAY_FRAMES
+#define LED_BENCHMARK_LOOP_HZ    LED_REPLAY_LOOP_HZ
+
+void runLedBenchmark(LedManager& ledManager, Print& out) {
+    ledManager.setMaxRPM(LED_REPLAY_MAX_RPM);
+    ledManager.resetStats();
+#ifdef LED_FRAME_RECORDER
+    ledManager.clearRecordedFrames();
+#endif
+
+    uint32_t totalCycles = 0;
+    uint32_t maxCycles = 0;
+
+    for (uint32_t frame = 0; frame < LED_BENCHMARK_FRAMES; frame++) {
+        uint32_t start = ESP.getCycleCount();
+        ledReplayStep(ledManager, frame);
+        uint32_t cycles = ESP.getCycleCount() - start;
+        totalCycles += cycles;
+        if (cycles > maxCycles) maxCycles = cycles;
+    }
+
+    const LedStats& stats = ledManager.getStats();
+    uint32_t cpuMHz = ESP.getCpuFreqMHz();
+
+    out.println(F("=== LED benchmark ==="));
+    out.printf("frames: %u\n", LED_BENCHMARK_FRAMES);
+    out.printf("update: avg %u us, max %u us\n",
+        totalCycles / LED_BENCHMARK_FRAMES / cpuMHz, maxCycles / cpuMHz);
+    out.printf("shows: %u sent, %u redundant\n", stats.shows, stats.redundantShows);
+    out.printf("i2c: %u writes (%u redundant), %u/s @%uHz\n",
+        stats.i2cWrites, stats.redundantI2cWrites,
+        stats.i2cWrites * LED_BENCHMARK_LOOP_HZ / LED_BENCHMARK_FRAMES, LED_BENCHMARK_LOOP_HZ);
+
+#ifdef LED_FRAME_RECORDER
+    out.printf("recorded frames: %u\n", ledManager.getRecordedFrameCount());
+    ledManager.exportFrames(out);
+#endif
+}
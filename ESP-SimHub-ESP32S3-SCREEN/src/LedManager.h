@@ -3,6 +3,7 @@
 #include <FastLED.h>
 #include <Wire.h>
 #include <Adafruit_PWMServoDriver.h>
+#include <driver/ledc.h>
 #include "Config.h"
 
 /*
@@ -66,7 +67,7 @@
  *    - GND  -> GND
  * 
  * 2. Controle de Brilho com IRLZ34N:
- *    - Gate   -> Pino PWM do ESP32 (ex: GPIO 4)
+ *    - Gate   -> Pino PWM do ESP32 (BRIGHTNESS_PIN, GPIO 38)
  *    - Drain  -> GND dos WS2812B
  *    - Source -> GND da fonte
  *    - Resistor 10k entre Gate e GND (pull-down)
@@ -108,13 +109,55 @@
 #define NUM_BUTTON_LEDS 10   // LEDs simples dos botões
 #define MAX_BRIGHTNESS 255   // Brilho máximo
 
+// Perfis de brilho da fita
+enum BrightnessProfile {
+    BRIGHTNESS_PROFILE_DAY,
+    BRIGHTNESS_PROFILE_NIGHT,
+    BRIGHTNESS_PROFILE_AUTO   // Segue a luz ambiente entre o mínimo da noite e o máximo do dia
+};
+
 // Endereço I2C do PCA9685
 #define PCA9685_I2C_ADDRESS 0x40
 
+// Tempo sem quadros do SimHub até voltar para o desenho interno de RPM/flags
+#define SIMHUB_FRAME_TIMEOUT_MS 2000
+
+#ifdef LED_BENCHMARK
+#define LED_STAT(expr) expr
+#else
+#define LED_STAT(expr)
+#endif
+
+#ifdef LED_FRAME_RECORDER
+// Um quadro gravado: fita + canais do PCA9685 no instante em que foram enviados
+struct LedFrameRecord {
+    uint32_t timestamp;   // micros()
+    CRGB leds[NUM_LEDS];
+    uint16_t buttonPwm[NUM_BUTTON_LEDS];
+};
+#endif
+
+// Contadores de envio, usados pelo benchmark
+struct LedStats {
+    uint32_t shows;              // FastLED.show() realmente enviados
+    uint32_t redundantShows;     // Quadros iguais ao anterior que deixaram de ser enviados
+    uint32_t i2cWrites;          // Escritas no PCA9685
+    uint32_t redundantI2cWrites; // Escritas com o mesmo valor que o canal já tinha
+};
+
 class LedManager {
 private:
     CRGB leds[NUM_LEDS];
+    CRGB shownLeds[NUM_LEDS];   // Último quadro enviado para a fita
     Adafruit_PWM_Servo_Driver pwm;
+
+    unsigned long lastSimHubFrame;
+    bool simHubFrameActive;
+
+    BrightnessProfile brightnessProfile;
+    uint8_t stripBrightness;
+    uint8_t ambientLight;
+    unsigned long lastAmbientSample;
     
     int maxRPM;
     int currentRPM;
@@ -124,6 +167,16 @@ private:
     bool blueFlagActive;
     
     uint8_t buttonLedBrightness[NUM_BUTTON_LEDS];
+    uint16_t buttonLedPwm[NUM_BUTTON_LEDS];
+
+    LedStats stats;
+
+#ifdef LED_FRAME_RECORDER
+    LedFrameRecord frameLog[LED_RECORDER_FRAMES];
+    uint16_t frameLogHead;
+    uint32_t frameLogCount;
+    bool buttonPwmChanged;     // Botões mudaram desde o último quadro gravado
+#endif
 
     // Cores predefinidas
     const CRGB COLOR_RPM_LOW = CRGB::Green;
@@ -136,6 +189,12 @@ private:
 public:
     LedManager() : 
         pwm(PCA9685_I2C_ADDRESS),
+        lastSimHubFrame(0),
+        simHubFrameActive(false),
+        brightnessProfile(BRIGHTNESS_PROFILE_DAY),
+        stripBrightness(0),
+        ambientLight(255),
+        lastAmbientSample(0),
         maxRPM(0),
         currentRPM(0),
         drsZone(false),
@@ -143,12 +202,27 @@ public:
         yellowFlagActive(false),
         blueFlagActive(false) {
             memset(buttonLedBrightness, 0, sizeof(buttonLedBrightness));
+            memset(buttonLedPwm, 0, sizeof(buttonLedPwm));
+            memset(shownLeds, 0, sizeof(shownLeds));
+            memset(&stats, 0, sizeof(stats));
+#ifdef LED_FRAME_RECORDER
+            frameLogHead = 0;
+            frameLogCount = 0;
+            buttonPwmChanged = false;
+#endif
     }
 
     void begin() {
         // Inicializa LEDs endereçáveis
         FastLED.addLeds<WS2812B, LED_PIN, GRB>(leds, NUM_LEDS);
-        FastLED.setBrightness(MAX_BRIGHTNESS);
+        // Cores com resolução total; o brilho global fica no MOSFET via LEDC
+        FastLED.setBrightness(255);
+
+        // Dimmer por hardware no BRIGHTNESS_PIN
+        ledcSetup(BRIGHTNESS_LEDC_CHANNEL, BRIGHTNESS_PWM_FREQ, BRIGHTNESS_PWM_BITS);
+        ledcAttachPin(BRIGHTNESS_PIN, BRIGHTNESS_LEDC_CHANNEL);
+        ledc_fade_func_install(0);
+        setBrightnessProfile(brightnessProfile);
         
         // Inicializa PCA9685
         pwm.begin();
@@ -172,15 +246,94 @@ public:
         updateRPMLeds();
     }
 
+    // Brilho global da fita (0-255). O fade roda no periférico LEDC,
+    // sem recalcular nem reenviar os pixels
+    void setStripBrightness(uint8_t level, uint16_t fadeMs = BRIGHTNESS_FADE_MS) {
+        if (level == stripBrightness) return;
+        stripBrightness = level;
+
+        uint32_t duty = ((uint32_t)level * ((1 << BRIGHTNESS_PWM_BITS) - 1)) / 255;
+        ledc_channel_t channel = (ledc_channel_t)(BRIGHTNESS_LEDC_CHANNEL % LEDC_CHANNEL_MAX);
+        if (fadeMs == 0) {
+            ledc_set_duty_and_update(LEDC_LOW_SPEED_MODE, channel, duty, 0);
+        } else {
+            ledc_set_fade_time_and_start(LEDC_LOW_SPEED_MODE, channel, duty, fadeMs, LEDC_FADE_NO_WAIT);
+        }
+    }
+
+    uint8_t getStripBrightness() {
+        return stripBrightness;
+    }
+
+    void setBrightnessProfile(BrightnessProfile profile) {
+        brightnessProfile = profile;
+        applyBrightnessProfile(true);
+    }
+
+    // Luz ambiente 0 (escuro) - 255 (claro), usada pelo perfil automático
+    void setAmbientLight(uint8_t level) {
+        ambientLight = level;
+        applyBrightnessProfile(false);
+    }
+
     void setButtonLED(uint8_t index, uint8_t brightness) {
         if (index < NUM_BUTTON_LEDS) {
             buttonLedBrightness[index] = brightness;
             // Mapeia o brilho de 0-255 para 0-4095 (resolução do PCA9685)
             uint16_t pwmValue = map(brightness, 0, 255, 0, 4095);
+            LED_STAT(stats.i2cWrites++);
+            LED_STAT(if (pwmValue == buttonLedPwm[index]) stats.redundantI2cWrites++);
+#ifdef LED_FRAME_RECORDER
+            if (pwmValue != buttonLedPwm[index]) buttonPwmChanged = true;
+#endif
+            buttonLedPwm[index] = pwmValue;
             pwm.setPWM(index, 0, pwmValue);
         }
     }
 
+    const LedStats& getStats() {
+        return stats;
+    }
+
+    void resetStats() {
+        memset(&stats, 0, sizeof(stats));
+    }
+
+#ifdef LED_FRAME_RECORDER
+    uint32_t getRecordedFrameCount() {
+        return frameLogCount;
+    }
+
+    // Exporta os quadros gravados, do mais antigo ao mais novo, em CSV:
+    // timestamp_us, R G B de cada LED em hex, valores PWM dos botões
+    void exportFrames(Print& out) {
+        uint16_t stored = frameLogCount < LED_RECORDER_FRAMES ? frameLogCount : LED_RECORDER_FRAMES;
+        uint16_t index = (frameLogHead + LED_RECORDER_FRAMES - stored) % LED_RECORDER_FRAMES;
+
+        for (uint16_t n = 0; n < stored; n++) {
+            const LedFrameRecord& frame = frameLog[index];
+            out.print(frame.timestamp);
+            out.print(',');
+            for (int i = 0; i < NUM_LEDS; i++) {
+                char hex[7];
+                snprintf(hex, sizeof(hex), "%02X%02X%02X", frame.leds[i].r, frame.leds[i].g, frame.leds[i].b);
+                out.print(hex);
+            }
+            for (int i = 0; i < NUM_BUTTON_LEDS; i++) {
+                out.print(',');
+                out.print(frame.buttonPwm[i]);
+            }
+            out.println();
+            index = (index + 1) % LED_RECORDER_FRAMES;
+        }
+    }
+
+    void clearRecordedFrames() {
+        frameLogHead = 0;
+        frameLogCount = 0;
+    }
+#endif
+
     void setDRSZone(bool active) {
         drsZone = active;
         updateDRSLeds();
@@ -208,10 +361,37 @@ public:
     }
 
     void update() {
+#ifdef AMBIENT_LIGHT_PIN
+        if (millis() - lastAmbientSample >= AMBIENT_SAMPLE_MS) {
+            lastAmbientSample = millis();
+            setAmbientLight(analogRead(AMBIENT_LIGHT_PIN) >> 4);
+        }
+#endif
+
+        // Enquanto o SimHub estiver mandando quadros, o buffer é dele
+        if (simHubOwnsStrip()) {
+            return;
+        }
+
         updateRPMLeds();
         updateDRSLeds();
         updateFlagLeds();
-        FastLED.show();
+        showIfChanged();
+    }
+
+    // Protocolo RGB do SimHub: os bytes de cor são escritos direto neste buffer
+    CRGB* beginSimHubFrame() {
+        return leds;
+    }
+
+    void endSimHubFrame() {
+        lastSimHubFrame = millis();
+        simHubFrameActive = true;
+        showIfChanged();
+    }
+
+    uint8_t getLedCount() {
+        return NUM_LEDS;
     }
 
     void handleWheelEvents(bool drsActive, bool yellowFlag, bool blueFlag) {
@@ -226,7 +406,66 @@ public:
     }
 
 private:
+    void applyBrightnessProfile(bool force) {
+        uint8_t target;
+        switch (brightnessProfile) {
+            case BRIGHTNESS_PROFILE_NIGHT:
+                target = BRIGHTNESS_NIGHT_MAX;
+                break;
+            case BRIGHTNESS_PROFILE_AUTO:
+                target = map(ambientLight, 0, 255, BRIGHTNESS_NIGHT_MIN, BRIGHTNESS_DAY_MAX);
+                break;
+            default:
+                target = BRIGHTNESS_DAY_MAX;
+                break;
+        }
+
+        // Evita ficar refazendo fades por ruído do sensor
+        if (!force && abs((int)target - (int)stripBrightness) < BRIGHTNESS_HYSTERESIS) return;
+        setStripBrightness(target);
+    }
+
+    bool simHubOwnsStrip() {
+        if (simHubFrameActive && millis() - lastSimHubFrame >= SIMHUB_FRAME_TIMEOUT_MS) {
+            simHubFrameActive = false;
+        }
+        return simHubFrameActive;
+    }
+
+    // Só envia para a fita quando o quadro é diferente do último mostrado.
+    // O gravador guarda no máximo um quadro por chamada, e só se a fita ou
+    // algum botão mudou desde o último
+    void showIfChanged() {
+        bool stripChanged = memcmp(leds, shownLeds, sizeof(leds)) != 0;
+        if (stripChanged) {
+            memcpy(shownLeds, leds, sizeof(leds));
+            LED_STAT(stats.shows++);
+            FastLED.show();
+        } else {
+            LED_STAT(stats.redundantShows++);
+        }
+#ifdef LED_FRAME_RECORDER
+        if (stripChanged || buttonPwmChanged) {
+            buttonPwmChanged = false;
+            recordFrame();
+        }
+#endif
+    }
+
+#ifdef LED_FRAME_RECORDER
+    void recordFrame() {
+        LedFrameRecord& frame = frameLog[frameLogHead];
+        frame.timestamp = micros();
+        memcpy(frame.leds, shownLeds, sizeof(frame.leds));
+        memcpy(frame.buttonPwm, buttonLedPwm, sizeof(frame.buttonPwm));
+        frameLogHead = (frameLogHead + 1) % LED_RECORDER_FRAMES;
+        frameLogCount++;
+    }
+#endif
+
     void updateRPMLeds() {
+        if (simHubOwnsStrip()) return;
+
         int numLedsToLight = map(currentRPM, 0, maxRPM, 0, NUM_LEDS);
         
         for (int i = 0; i < NUM_LEDS; i++) {
@@ -247,6 +486,8 @@ private:
     }
 
     void updateDRSLeds() {
+        if (simHubOwnsStrip()) return;
+
         // Usa os últimos 2 LEDs para indicação de DRS
         if (drsZone) {
             if (drsEnabled) {
@@ -263,6 +504,8 @@ private:
     }
 
     void updateFlagLeds() {
+        if (simHubOwnsStrip()) return;
+
         // Usa os primeiros LEDs para flags
         if (yellowFlagActive) {
             leds[0] = COLOR_YELLOW_FLAG;
@@ -279,6 +522,7 @@ private:
     void clearAll() {
         // Limpa LEDs endereçáveis
         fill_solid(leds, NUM_LEDS, CRGB::Black);
+        memcpy(shownLeds, leds, sizeof(leds));
         FastLED.show();
         
         // Limpa LEDs dos botões
@@ -0,0 +1,39 @@
+#pragma once
+#include <Arduino.h>
+#include "LedManager.h"
+
+/*
+ * TELEMETRIA SINTÉTICA DOS LEDS
+ * -----------------------------
+ * Um quadro do loop principal com uma telemetria fixa: varredura de RPM,
+ * zona/ativação de DRS, bandeira amarela (quadros 1000-1199) e azul
+ * (1500-1599). Usada pelo benchmark no dispositivo (LedBenchmark.h) e pelo
+ * replay nativo com FastLED/PCA9685 simulados (test/test_led_replay).
+ */
+
+#define LED_REPLAY_FRAMES     2000
+#define LED_REPLAY_MAX_RPM    9000
+#define LED_REPLAY_LOOP_HZ    100   // Mesma taxa do WHEEL_UPDATE_INTERVAL
+
+// RPM do quadro: a telemetria chega a ~20Hz, então só muda a cada 5 voltas do loop
+inline int ledReplayRpm(uint32_t frame) {
+    uint32_t phase = (frame / 5) % 100;
+    return (phase < 50 ? phase : 100 - phase) * LED_REPLAY_MAX_RPM / 50;
+}
+
+// Mesma sequência de chamadas do loop principal
+inline void ledReplayStep(LedManager& ledManager, uint32_t frame) {
+    bool drsZone = (frame / 500) % 2;
+    bool drsEnabled = drsZone && (frame % 500) > 250;
+    bool yellowFlag = frame >= 1000 && frame < 1200;
+    bool blueFlag = frame >= 1500 && frame < 1600;
+
+    ledManager.updateRPM(ledReplayRpm(frame));
+    ledManager.setDRSZone(drsZone);
+    ledManager.setDRSEnabled(drsEnabled);
+    if (yellowFlag) ledManager.setYellowFlag();
+    if (blueFlag) ledManager.setBlueFlag();
+    if (!yellowFlag && !blueFlag) ledManager.clearFlags();
+    ledManager.update();
+    ledManager.handleWheelEvents(drsEnabled, yellowFlag, blueFlag);
+}
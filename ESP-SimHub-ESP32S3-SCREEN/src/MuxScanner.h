@@ -0,0 +1,331 @@
+#pragma once
+#include <Arduino.h>
+#include <soc/gpio_reg.h>
+#include <hal/cpu_hal.h>
+#include "InputEventQueue.h"
+#include "VerticalDebouncer.h"
+
+/*
+ * VARREDURA DOS MULTIPLEXADORES POR TIMER
+ * ---------------------------------------
+ * Um timer de hardware dispara a varredura a MUX_SCAN_RATE_HZ. Cada varredura
+ * passa pelos 16 canais uma única vez lendo MUX1 (encoders) e MUX2 (botões)
+ * ao mesmo tempo, já que os dois compartilham S0-S3.
+ *
+ * Os pares CLK/DT do MUX1 alimentam um decodificador de quadratura por tabela,
+ * então giros rápidos não perdem detents entre os ciclos de 10ms do volante.
+ *
+ * A varredura é em pipeline: os canais seguem o código Gray, então trocar de
+ * canal muda só um pino de seleção (uma escrita em GPIO_OUT_W1TS/W1TC). Logo
+ * depois da troca a amostra anterior é processada, e só então o pino de sinal
+ * é lido. Só se espera o que faltar do tempo de estabilização.
+ *
+ * A mesma varredura amostra os paddles e o botão do joystick, faz o debounce
+ * de todos os botões de uma vez (VerticalDebouncer) e publica pressionamentos, solturas e detents dos
+ * encoders, com timestamp, na InputEventQueue.
+ *
+ * Com MUX_SCAN_PROFILE definido, o begin() mede em ciclos de CPU a varredura
+ * antiga (digitalWrite + delayMicroseconds(5)) e a nova, e imprime na Serial.
+ *
+ * Usa os pinos definidos no WheelController.h (MUX1_SIG, MUX2_SIG, MUX_S0-S3,
+ * SHIFTER_UP, SHIFTER_DOWN, JOY_SW).
+ */
+
+#define MUX_SCAN_RATE_HZ          2000
+#define MUX_SCAN_TIMER            0      // Timer de hardware usado pela varredura
+#define MUX_CHANNELS              16
+#define MUX_SETTLE_NS             1000   // Tempo para o sinal estabilizar após trocar o canal
+#define MUX_PROFILE_SCANS         100    // Varreduras medidas com MUX_SCAN_PROFILE
+#define ENCODER_STEPS_PER_DETENT  4      // Quadratura completa: 4 transições por detent
+
+// Cada encoder usa dois canais do MUX1 (CLK no par, DT no ímpar)
+#define MUX_ENCODER_COUNT ((MUX_CHANNELS / 2) < NUM_ENCODERS ? (MUX_CHANNELS / 2) : NUM_ENCODERS)
+
+// Ordem de varredura em código Gray: um único bit de seleção muda por passo,
+// e os pares CLK/DT de cada encoder ficam em passos consecutivos
+static const uint8_t MUX_GRAY_SEQUENCE[MUX_CHANNELS] = {
+    0, 1, 3, 2, 6, 7, 5, 4, 12, 13, 15, 14, 10, 11, 9, 8
+};
+
+// Índice: (AB anterior << 2) | AB atual. Transições inválidas (dois bits mudando) valem 0
+static const int8_t QUADRATURE_TABLE[16] = {
+     0, -1, +1,  0,
+    +1,  0,  0, -1,
+    -1,  0,  0, +1,
+     0, +1, -1,  0
+};
+
+class MuxScanner;
+MuxScanner* muxScannerInstance = nullptr;
+
+class MuxScanner {
+private:
+    hw_timer_t* timer;
+
+    // Último estado de cada canal, um bit por canal
+    volatile uint16_t mux1Bits;
+    volatile uint16_t mux2Bits;
+
+    volatile int32_t encoderCounts[NUM_ENCODERS];
+    uint8_t encoderAB[NUM_ENCODERS];
+    int32_t encoderDetents[NUM_ENCODERS];   // Último detent publicado na fila
+
+    InputEventQueue* queue;
+
+    // Botões com debounce, um bit por INPUT_ID_* (1 = pressionado)
+    volatile uint32_t buttonState;
+    VerticalDebouncer debouncer;
+#ifdef INPUT_LATENCY_BENCHMARK
+    volatile uint32_t injectedButtons = 0;   // Bordas simuladas do benchmark
+#endif
+
+    volatile uint32_t scanCount;
+
+    // Escrita de troca de canal pré-calculada para cada passo da sequência
+    uint32_t stepSelectReg[MUX_CHANNELS];
+    uint32_t stepSelectMask[MUX_CHANNELS];
+    uint32_t settleCycles;
+
+    volatile uint32_t lastScanCycles;
+    volatile uint32_t maxScanCycles;
+
+    static void IRAM_ATTR onTimer() {
+        muxScannerInstance->scan();
+    }
+
+    void IRAM_ATTR scan() {
+        uint32_t scanStart = cpu_hal_get_cycle_count();
+        // O canal 0 foi selecionado no fim da varredura anterior e já estabilizou
+        uint32_t switchedAt = scanStart - settleCycles;
+        uint32_t bits1 = 0;
+        uint32_t bits2 = 0;
+        uint32_t in = 0;
+
+        for (uint8_t step = 0; step < MUX_CHANNELS; step++) {
+            // Espera só o que falta do tempo de estabilização
+            while (cpu_hal_get_cycle_count() - switchedAt < settleCycles) {}
+            in = REG_READ(GPIO_IN_REG);
+
+            // Já seleciona o próximo canal (no último passo volta ao canal 0)
+            uint8_t next = (step + 1) % MUX_CHANNELS;
+            REG_WRITE(stepSelectReg[next], stepSelectMask[next]);
+            switchedAt = cpu_hal_get_cycle_count();
+
+            // Processa a amostra enquanto o próximo canal estabiliza
+            uint8_t channel = MUX_GRAY_SEQUENCE[step];
+            bits1 |= ((in >> MUX1_SIG) & 0x01) << channel;
+            bits2 |= ((in >> MUX2_SIG) & 0x01) << channel;
+
+            // Segundo canal do par: o encoder já tem CLK e DT desta varredura
+            if (step & 0x01) {
+                uint8_t i = channel >> 1;
+                if (i < MUX_ENCODER_COUNT) {
+                    uint8_t ab = (bits1 >> (i * 2)) & 0x03;
+                    encoderCounts[i] += QUADRATURE_TABLE[(encoderAB[i] << 2) | ab];
+                    encoderAB[i] = ab;
+                }
+            }
+        }
+
+        mux1Bits = bits1;
+        mux2Bits = bits2;
+        scanCount++;
+
+        uint32_t now = micros();
+        publishEncoders(now);
+
+        // Paddles e joystick vêm da última leitura do GPIO_IN_REG
+        uint32_t raw = bits2 |
+            ((in >> SHIFTER_UP) & 0x01) << INPUT_ID_PADDLE_UP |
+            ((in >> SHIFTER_DOWN) & 0x01) << INPUT_ID_PADDLE_DOWN |
+            ((in >> JOY_SW) & 0x01) << INPUT_ID_JOYSTICK;
+        // Todos com pullup: nível baixo = pressionado
+        uint32_t pressed = ~raw & ((1UL << INPUT_BUTTON_COUNT) - 1);
+#ifdef INPUT_LATENCY_BENCHMARK
+        pressed |= injectedButtons;
+#endif
+        debounceButtons(pressed, now);
+
+        uint32_t cycles = cpu_hal_get_cycle_count() - scanStart;
+        lastScanCycles = cycles;
+        if (cycles > maxScanCycles) maxScanCycles = cycles;
+    }
+
+    void IRAM_ATTR publishEncoders(uint32_t now) {
+        for (uint8_t i = 0; i < MUX_ENCODER_COUNT; i++) {
+            int32_t detents = encoderCounts[i] / ENCODER_STEPS_PER_DETENT;
+            if (detents != encoderDetents[i]) {
+                InputEvent event = {now, INPUT_EVENT_ENCODER, i, (int8_t)(detents - encoderDetents[i])};
+                queue->push(event);
+                encoderDetents[i] = detents;
+            }
+        }
+    }
+
+    // Debounce de todos os botões de uma vez; só percorre os bits que mudaram
+    void IRAM_ATTR debounceButtons(uint32_t pressed, uint32_t now) {
+        if (!debouncer.update(pressed)) return;
+        buttonState = debouncer.getState();
+
+        uint32_t edges = debouncer.getPressedEdges();
+        while (edges) {
+            uint8_t id = __builtin_ctz(edges);
+            edges &= edges - 1;
+            InputEvent event = {now, INPUT_EVENT_PRESS, id, 0};
+            queue->push(event);
+        }
+        edges = debouncer.getReleasedEdges();
+        while (edges) {
+            uint8_t id = __builtin_ctz(edges);
+            edges &= edges - 1;
+            InputEvent event = {now, INPUT_EVENT_RELEASE, id, 0};
+            queue->push(event);
+        }
+    }
+
+    void prepareSelectWrites() {
+        const uint8_t selectPins[4] = {MUX_S0, MUX_S1, MUX_S2, MUX_S3};
+
+        for (uint8_t step = 0; step < MUX_CHANNELS; step++) {
+            uint8_t channel = MUX_GRAY_SEQUENCE[step];
+            uint8_t previous = MUX_GRAY_SEQUENCE[(step + MUX_CHANNELS - 1) % MUX_CHANNELS];
+            uint8_t bit = __builtin_ctz(channel ^ previous);
+
+            stepSelectMask[step] = 1UL << selectPins[bit];
+            stepSelectReg[step] = (channel & (1 << bit)) ? GPIO_OUT_W1TS_REG : GPIO_OUT_W1TC_REG;
+        }
+
+        // Deixa o canal 0 selecionado para a primeira varredura
+        for (uint8_t bit = 0; bit < 4; bit++) {
+            digitalWrite(selectPins[bit], LOW);
+        }
+    }
+
+#ifdef MUX_SCAN_PROFILE
+    // Varredura como era feita no WheelController::loop(), para comparação
+    void legacySetMuxChannel(uint8_t channel) {
+        digitalWrite(MUX_S0, channel & 0x01);
+        digitalWrite(MUX_S1, (channel >> 1) & 0x01);
+        digitalWrite(MUX_S2, (channel >> 2) & 0x01);
+        digitalWrite(MUX_S3, (channel >> 3) & 0x01);
+        delayMicroseconds(5);
+    }
+
+    uint32_t legacyScan() {
+        uint32_t start = cpu_hal_get_cycle_count();
+        for (int i = 0; i < NUM_ENCODERS; i++) {
+            legacySetMuxChannel(i * 2);
+            delayMicroseconds(5);
+            legacySetMuxChannel(i * 2 + 1);
+            delayMicroseconds(5);
+            legacySetMuxChannel(i);
+            digitalRead(MUX2_SIG);
+        }
+        return cpu_hal_get_cycle_count() - start;
+    }
+
+    void printProfile(Print& out) {
+        uint32_t legacyTotal = 0;
+        uint32_t legacyMax = 0;
+        for (int n = 0; n < MUX_PROFILE_SCANS; n++) {
+            uint32_t cycles = legacyScan();
+            legacyTotal += cycles;
+            if (cycles > legacyMax) legacyMax = cycles;
+        }
+
+        prepareSelectWrites();
+        delayMicroseconds(5);
+        uint32_t pipelinedTotal = 0;
+        maxScanCycles = 0;
+        for (int n = 0; n < MUX_PROFILE_SCANS; n++) {
+            scan();
+            pipelinedTotal += lastScanCycles;
+        }
+
+        uint32_t cpuMHz = ESP.getCpuFreqMHz();
+        out.println(F("=== Mux scan profile ==="));
+        out.printf("legacy:    avg %u cycles (%u us), max %u cycles\n",
+            legacyTotal / MUX_PROFILE_SCANS, legacyTotal / MUX_PROFILE_SCANS / cpuMHz, legacyMax);
+        out.printf("pipelined: avg %u cycles (%u us), max %u cycles\n",
+            pipelinedTotal / MUX_PROFILE_SCANS, pipelinedTotal / MUX_PROFILE_SCANS / cpuMHz, maxScanCycles);
+    }
+#endif
+
+public:
+    MuxScanner() :
+        timer(nullptr),
+        mux1Bits(0),
+        mux2Bits(0xFFFF),
+        queue(nullptr),
+        buttonState(0),
+        scanCount(0),
+        settleCycles(0),
+        lastScanCycles(0),
+        maxScanCycles(0) {
+        for (int i = 0; i < NUM_ENCODERS; i++) {
+            encoderCounts[i] = 0;
+            encoderAB[i] = 0;
+            encoderDetents[i] = 0;
+        }
+    }
+
+    void begin(InputEventQueue* eventQueue, uint32_t rateHz = MUX_SCAN_RATE_HZ) {
+        muxScannerInstance = this;
+        queue = eventQueue;
+        setDebounceMs(DEBOUNCE_MS, rateHz);
+        settleCycles = (uint32_t)ESP.getCpuFreqMHz() * MUX_SETTLE_NS / 1000;
+
+#ifdef MUX_SCAN_PROFILE
+        printProfile(Serial);
+#endif
+        prepareSelectWrites();
+
+        timer = timerBegin(MUX_SCAN_TIMER, 80, true);  // 80MHz / 80 = ticks de 1µs
+        timerAttachInterrupt(timer, &MuxScanner::onTimer, true);
+        timerAlarmWrite(timer, 1000000 / rateHz, true);
+        timerAlarmEnable(timer);
+    }
+
+    // Tempo de integração do debounce, em múltiplos de 4 varreduras
+    void setDebounceMs(uint32_t ms, uint32_t rateHz = MUX_SCAN_RATE_HZ) {
+        debouncer.setIntegrationSamples(ms * rateHz / 1000);
+    }
+
+#ifdef INPUT_LATENCY_BENCHMARK
+    // Botões somados à próxima amostra, como se estivessem pressionados
+    void injectButtons(uint32_t mask) {
+        injectedButtons = mask;
+    }
+#endif
+
+    // Posição do encoder em detents
+    int32_t getEncoderDetents(uint8_t index) const {
+        return (index < NUM_ENCODERS) ? encoderCounts[index] / ENCODER_STEPS_PER_DETENT : 0;
+    }
+
+    bool readMux1(uint8_t channel) const {
+        return (mux1Bits >> channel) & 0x01;
+    }
+
+    bool readMux2(uint8_t channel) const {
+        return (mux2Bits >> channel) & 0x01;
+    }
+
+    // Botões com debounce, um bit por INPUT_ID_* (1 = pressionado)
+    uint32_t getButtonState() const {
+        return buttonState;
+    }
+
+    uint32_t getScanCount() const {
+        return scanCount;
+    }
+
+    // Duração da última varredura e a maior já vista, em ciclos de CPU
+    uint32_t getLastScanCycles() const {
+        return lastScanCycles;
+    }
+
+    uint32_t getMaxScanCycles() const {
+        return maxScanCycles;
+    }
+};
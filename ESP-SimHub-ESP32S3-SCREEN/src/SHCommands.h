@@ -92,10 +92,63 @@ void Command_Features()
 
 void Command_RGBLEDSCount()
 {
-	FlowSerialWrite((byte)(0));
+	FlowSerialWrite((byte)(ledManager.getLedCount()));
 	FlowSerialFlush();
 }
 
+// Reads one color straight into the strip buffer, discarding leds we don't have
+void ReadRGBLed(CRGB *leds, int index)
+{
+	CRGB discard;
+	CRGB &led = (index >= 0 && index < ledManager.getLedCount()) ? leds[index] : discard;
+	led.r = FlowSerialTimedRead();
+	led.g = FlowSerialTimedRead();
+	led.b = FlowSerialTimedRead();
+}
+
+void Command_RGBLEDSData()
+{
+	CRGB *leds = ledManager.beginSimHubFrame();
+	int count = ledManager.getLedCount();
+	int j;
+
+	int mode = FlowSerialTimedRead();
+	while (mode > 0)
+	{
+		// full frame
+		if (mode == 1) {
+			for (j = 0; j < count; j++) {
+				ReadRGBLed(leds, j);
+			}
+		}
+		// partial frame: start, count, colors
+		else if (mode == 2) {
+			int startLed = FlowSerialTimedRead();
+			int numberOfLeds = FlowSerialTimedRead();
+			for (j = startLed; j < startLed + numberOfLeds; j++) {
+				ReadRGBLed(leds, j);
+			}
+		}
+		// repeated color: start, count, one color
+		else if (mode == 3) {
+			int startLed = FlowSerialTimedRead();
+			int numberOfLeds = FlowSerialTimedRead();
+			CRGB color;
+			ReadRGBLed(&color, 0);
+			for (j = startLed; j < startLed + numberOfLeds && j < count; j++) {
+				leds[j] = color;
+			}
+		}
+		mode = FlowSerialTimedRead();
+	}
+
+	// only shows if the frame differs from the last one
+	ledManager.endSimHubFrame();
+
+	// Acq !
+	FlowSerialWrite(0x15);
+}
+
 void Command_RGBMatrixData()
 {
 	// Acq !
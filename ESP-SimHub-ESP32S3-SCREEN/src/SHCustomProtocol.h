@@ -4,6 +4,10 @@
 #include <Arduino.h>
 #include <Arduino_GFX_Library.h>
 #include <map>
+#include "Config.h"
+#if UDP_TELEMETRY_ENABLED
+#include <UdpTelemetry.h>
+#endif
 
 #define TFT_BL 2 // backlight pin
 
@@ -98,41 +102,100 @@ public:
 
 	// Called when new data is coming from computer
 	void read() {
+		const String line = FlowSerialReadStringUntil('\n');
+
+		// Button mapping edits share the custom protocol: MAP;<input>;<button> or MAP;RESET
+		if (line.startsWith(F("MAP;"))) {
+			readMapping(line.substring(4));
+			return;
+		}
+
+#if UDP_TELEMETRY_ENABLED
+		// The UDP frames are newer while that channel is live, drop this copy
+		if (!udpTelemetry.acceptStreamFrame()) {
+			return;
+		}
+#endif
+		readTelemetry(line);
+	}
+
+	// Telemetry fields of one frame, from the stream or from the UDP fast path
+	void readTelemetry(const String &line) {
 		if (!hasReceivedData) {
 			hasReceivedData = true;
 			gfx->fillScreen(BLACK);
 		}
-		String full = "";
-
-		speed = FlowSerialReadStringUntil(';').toInt();
-		gear = FlowSerialReadStringUntil(';');
-		rpmPercent = FlowSerialReadStringUntil(';').toInt();
-		rpmRedLineSetting = FlowSerialReadStringUntil(';').toInt();
-		currentLapTime = FlowSerialReadStringUntil(';');
-		lastLapTime = FlowSerialReadStringUntil(';');
-		bestLapTime = FlowSerialReadStringUntil(';');
-		sessionBestLiveDeltaSeconds = FlowSerialReadStringUntil(';');
-		sessionBestLiveDeltaProgressSeconds = FlowSerialReadStringUntil(';');
-		tyrePressureFrontLeft  = FlowSerialReadStringUntil(';');
-		tyrePressureFrontRight  = FlowSerialReadStringUntil(';');
-		tyrePressureRearLeft  = FlowSerialReadStringUntil(';');
-		tyrePressureRearRight  = FlowSerialReadStringUntil(';');
-		tcLevel  = FlowSerialReadStringUntil(';');
-		tcActive  = FlowSerialReadStringUntil(';');
-		absLevel  = FlowSerialReadStringUntil(';');
-		absActive  = FlowSerialReadStringUntil(';');
-		isTCCutNull  = FlowSerialReadStringUntil(';');
-		tcTcCut  = FlowSerialReadStringUntil(';');
-		brakeBias  = FlowSerialReadStringUntil(';');
-		brake  = FlowSerialReadStringUntil(';');
-		lapInvalidated  = FlowSerialReadStringUntil(';');
-
-		const String rest = FlowSerialReadStringUntil('\n');
+		int position = 0;
+
+		speed = nextField(line, position).toInt();
+		gear = nextField(line, position);
+		rpmPercent = nextField(line, position).toInt();
+		rpmRedLineSetting = nextField(line, position).toInt();
+		currentLapTime = nextField(line, position);
+		lastLapTime = nextField(line, position);
+		bestLapTime = nextField(line, position);
+		sessionBestLiveDeltaSeconds = nextField(line, position);
+		sessionBestLiveDeltaProgressSeconds = nextField(line, position);
+		tyrePressureFrontLeft  = nextField(line, position);
+		tyrePressureFrontRight  = nextField(line, position);
+		tyrePressureRearLeft  = nextField(line, position);
+		tyrePressureRearRight  = nextField(line, position);
+		tcLevel  = nextField(line, position);
+		tcActive  = nextField(line, position);
+		absLevel  = nextField(line, position);
+		absActive  = nextField(line, position);
+		isTCCutNull  = nextField(line, position);
+		tcTcCut  = nextField(line, position);
+		brakeBias  = nextField(line, position);
+		brake  = nextField(line, position);
+		lapInvalidated  = nextField(line, position);
+	}
+
+	// Text up to the next ';' (or the end of the line), advancing position past it
+	static String nextField(const String &line, int &position) {
+		int separator = line.indexOf(';', position);
+		if (separator < 0) {
+			separator = line.length();
+		}
+		String field = line.substring(position, separator);
+		position = separator + 1;
+		return field;
+	}
+
+	// Remaining fields of a MAP message; a button of -1 disables the input
+	void readMapping(const String &rest) {
+		if (rest.startsWith(F("RESET"))) {
+			inputMap.reset();
+			return;
+		}
+
+		int separator = rest.indexOf(';');
+		if (separator < 0) {
+			return;
+		}
+		int input = rest.substring(0, separator).toInt();
+		int button = rest.substring(separator + 1).toInt();
+		if (input < 0 || input >= INPUT_MAP_SIZE) {
+			return;
+		}
+		inputMap.set(input, (button < 0 || button >= HID_BUTTON_COUNT) ? INPUT_MAP_NONE : button);
 	}
 
 	// Called once per arduino loop, timing can't be predicted, 
 	// but it's called between each command sent to the arduino
 	void loop() {
+#if UDP_TELEMETRY_ENABLED
+		// Only the newest UDP frame is applied, older ones were already replaced
+		char frame[UDP_TELEMETRY_MAX_FRAME + 1];
+		size_t frameLength = udpTelemetry.take(frame, UDP_TELEMETRY_MAX_FRAME);
+		while (frameLength && (frame[frameLength - 1] == '\n' || frame[frameLength - 1] == '\r')) {
+			frameLength--;
+		}
+		if (frameLength) {
+			frame[frameLength] = 0;
+			readTelemetry(String(frame));
+		}
+#endif
 		if (!hasReceivedData) {
 			return;
 		}
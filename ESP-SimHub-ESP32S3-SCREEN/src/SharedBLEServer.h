@@ -0,0 +1,108 @@
+#pragma once
+#include <Arduino.h>
+#include <BLEDevice.h>
+#include <BLEServer.h>
+#include <BLEAdvertising.h>
+
+/*
+ * SERVIDOR BLE COMPARTILHADO
+ * --------------------------
+ * O BLEDevice entrega os eventos GATTS só ao último servidor criado: um
+ * segundo createServer() deixa o primeiro sem callbacks. O gamepad
+ * (WheelBLE) e o link de dados (BluetoothComm) pegam o mesmo servidor
+ * aqui, e os eventos de conexão são repassados a todos os interessados.
+ *
+ * O nome do dispositivo é o de quem chamar primeiro; o BLEDevice ignora
+ * os init() seguintes.
+ *
+ * Conexão no servidor não quer dizer que o host usa um serviço: cada um
+ * considera o host presente só depois que ele assina as notificações (CCCD).
+ *
+ * O anúncio também é montado aqui, porque o pacote de advertising tem só
+ * 31 bytes: flags, aparência, UUIDs de 16 bits e o nome vão no advertising
+ * (nome encurtado se não couber) e o UUID de 128 bits do link de dados
+ * (18 bytes) vai na resposta ao scan.
+ */
+
+#define SHARED_BLE_MAX_LISTENERS 4
+#define SHARED_BLE_MAX_SERVICES  4
+#define SHARED_BLE_ADV_MAX       31
+
+class SharedBLEServer : public BLEServerCallbacks {
+private:
+    BLEServer* server;
+    BLEServerCallbacks* listeners[SHARED_BLE_MAX_LISTENERS];
+    uint8_t listenerCount;
+    std::string name;
+    uint16_t appearance;
+    BLEUUID services[SHARED_BLE_MAX_SERVICES];
+    uint8_t serviceCount;
+
+public:
+    SharedBLEServer() : server(nullptr), listenerCount(0), appearance(0), serviceCount(0) {}
+
+    // Cria o servidor na primeira chamada e registra os callbacks de quem pediu
+    BLEServer* get(const char* deviceName, BLEServerCallbacks* callbacks) {
+        if (!server) {
+            name = deviceName;
+            BLEDevice::init(deviceName);
+            server = BLEDevice::createServer();
+            server->setCallbacks(this);
+        }
+        if (callbacks && listenerCount < SHARED_BLE_MAX_LISTENERS) {
+            listeners[listenerCount++] = callbacks;
+        }
+        return server;
+    }
+
+    void setAppearance(uint16_t value) {
+        appearance = value;
+    }
+
+    void addService(const BLEUUID& uuid) {
+        if (serviceCount < SHARED_BLE_MAX_SERVICES) services[serviceCount++] = uuid;
+    }
+
+    // Remonta o anúncio com os serviços registrados até agora e (re)inicia.
+    // Reinícios depois de uma desconexão usam o mesmo anúncio
+    void startAdvertising() {
+        BLEAdvertisementData advData;
+        BLEAdvertisementData scanData;
+        advData.setFlags(ESP_BLE_ADV_FLAG_GEN_DISC | ESP_BLE_ADV_FLAG_BREDR_NOT_SPT);
+        if (appearance) advData.setAppearance(appearance);
+        for (uint8_t i = 0; i < serviceCount; i++) {
+            if (services[i].bitSize() == 16) {
+                advData.setCompleteServices(services[i]);
+            } else if (scanData.getPayload().length() + 2 + 16 <= SHARED_BLE_ADV_MAX) {
+                scanData.setCompleteServices(services[i]);
+            }
+        }
+
+        // 2 bytes de cabeçalho por campo
+        size_t room = SHARED_BLE_ADV_MAX - advData.getPayload().length();
+        if (name.length() + 2 <= room) {
+            advData.setName(name);
+        } else if (room > 2) {
+            advData.setShortName(name.substr(0, room - 2));
+        }
+
+        BLEAdvertising* advertising = server->getAdvertising();
+        advertising->setAdvertisementData(advData);
+        advertising->setScanResponseData(scanData);
+        advertising->start();
+    }
+
+    void onConnect(BLEServer* pServer) override {
+        for (uint8_t i = 0; i < listenerCount; i++) listeners[i]->onConnect(pServer);
+    }
+
+    void onConnect(BLEServer* pServer, esp_ble_gatts_cb_param_t* param) override {
+        for (uint8_t i = 0; i < listenerCount; i++) listeners[i]->onConnect(pServer, param);
+    }
+
+    void onDisconnect(BLEServer* pServer) override {
+        for (uint8_t i = 0; i < listenerCount; i++) listeners[i]->onDisconnect(pServer);
+    }
+};
+
+SharedBLEServer sharedBleServer;
@@ -0,0 +1,92 @@
+#pragma once
+#include <Arduino.h>
+#include <SPI.h>
+
+/*
+ * LEDS DOS BOTÕES NO 74HC595 VIA SPI
+ * ----------------------------------
+ * Os LEDs ficam numa imagem de bits compactada (um bit por saída). set() só
+ * marca a imagem como suja; flush() manda a cadeia inteira pelo periférico
+ * SPI e dá o pulso de latch, e só quando algo mudou.
+ *
+ * A cadeia pode ter vários 74HC595 (Q7' de um no SER do seguinte):
+ * SR_OUTPUTS define o número total de saídas. A saída 0 é o Q0 do primeiro
+ * registrador, ligado ao ESP32.
+ *
+ * Usa os pinos definidos no WheelController.h: SR_DATA como MOSI, SR_CLOCK
+ * como SCK e SR_LATCH controlado manualmente. O display usa o outro host SPI.
+ */
+
+#define SR_OUTPUTS      16          // Saídas na cadeia (8 por 74HC595)
+#define SR_BYTES        ((SR_OUTPUTS + 7) / 8)
+#define SR_SPI_HOST     HSPI
+#define SR_SPI_FREQ     10000000    // 74HC595 aceita bem mais a 3.3V
+
+class ShiftRegisterLeds {
+private:
+    SPIClass spi;
+    uint8_t image[SR_BYTES];
+    bool dirty;
+    uint32_t transfers;
+
+public:
+    ShiftRegisterLeds() : spi(SR_SPI_HOST), dirty(true), transfers(0) {
+        memset(image, 0, sizeof(image));
+    }
+
+    void begin() {
+        pinMode(SR_LATCH, OUTPUT);
+        digitalWrite(SR_LATCH, LOW);
+        spi.begin(SR_CLOCK, -1, SR_DATA, -1);
+        dirty = true;
+        flush();
+    }
+
+    void set(uint16_t index, bool on) {
+        if (index >= SR_OUTPUTS) return;
+        uint8_t mask = 1 << (index & 0x07);
+        uint8_t& byte = image[index >> 3];
+        uint8_t value = on ? (byte | mask) : (byte & ~mask);
+        if (value != byte) {
+            byte = value;
+            dirty = true;
+        }
+    }
+
+    bool get(uint16_t index) const {
+        if (index >= SR_OUTPUTS) return false;
+        return image[index >> 3] & (1 << (index & 0x07));
+    }
+
+    void clear() {
+        for (int i = 0; i < SR_BYTES; i++) {
+            if (image[i]) dirty = true;
+            image[i] = 0;
+        }
+    }
+
+    // O último registrador da cadeia sai primeiro, MSB primeiro: a saída 0
+    // termina no Q0 do registrador ligado ao ESP32
+    bool flush() {
+        if (!dirty) return false;
+
+        uint8_t buffer[SR_BYTES];
+        for (int i = 0; i < SR_BYTES; i++) {
+            buffer[i] = image[SR_BYTES - 1 - i];
+        }
+
+        spi.beginTransaction(SPISettings(SR_SPI_FREQ, MSBFIRST, SPI_MODE0));
+        digitalWrite(SR_LATCH, LOW);
+        spi.writeBytes(buffer, SR_BYTES);
+        digitalWrite(SR_LATCH, HIGH);   // Borda de subida copia para as saídas
+        spi.endTransaction();
+
+        dirty = false;
+        transfers++;
+        return true;
+    }
+
+    uint32_t getTransferCount() const {
+        return transfers;
+    }
+};
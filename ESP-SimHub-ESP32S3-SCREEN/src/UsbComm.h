@@ -36,8 +36,9 @@ public:
         return usb->read(buffer, size);
     }
 
+    // Porta aberta no host (DTR), não só USB inicializado
     bool isConnected() override {
-        return connected;  // Por enquanto, só verifica se a conexão inicial foi feita
+        return connected && (bool)*usb;
     }
 
     const char* getName() override {
@@ -0,0 +1,72 @@
+#pragma once
+#include <Arduino.h>
+
+/*
+ * DEBOUNCE BIT-PARALELO (CONTADORES VERTICAIS)
+ * --------------------------------------------
+ * Todas as chaves entram numa única palavra de 32 bits, um bit por botão
+ * (1 = pressionado). Cada bit tem um contador de 2 bits espalhado em duas
+ * palavras (cnt0 = bit baixo, cnt1 = bit alto), então as 32 chaves são
+ * tratadas com meia dúzia de operações lógicas por amostra.
+ *
+ * Um botão só muda de estado depois de VERTICAL_DEBOUNCE_SAMPLES amostras
+ * seguidas diferentes do estado atual; qualquer amostra igual zera o
+ * contador. O tempo de integração é ajustado com um divisor: o contador só
+ * avança a cada `divider` chamadas de update().
+ */
+
+#define VERTICAL_DEBOUNCE_SAMPLES 4   // Fixo pelo contador de 2 bits
+
+class VerticalDebouncer {
+private:
+    uint32_t state;     // Estado com debounce
+    uint32_t cnt0;
+    uint32_t cnt1;
+    uint32_t pressedEdges;
+    uint32_t releasedEdges;
+    uint16_t divider;
+    uint16_t tick;
+
+public:
+    VerticalDebouncer() :
+        state(0),
+        cnt0(0),
+        cnt1(0),
+        pressedEdges(0),
+        releasedEdges(0),
+        divider(1),
+        tick(0) {}
+
+    // Integração em amostras da varredura, arredondada para múltiplos de 4
+    void setIntegrationSamples(uint32_t samples) {
+        uint32_t d = (samples + VERTICAL_DEBOUNCE_SAMPLES / 2) / VERTICAL_DEBOUNCE_SAMPLES;
+        divider = constrain(d, 1UL, 0xFFFFUL);
+        tick = 0;
+    }
+
+    uint32_t getIntegrationSamples() const {
+        return (uint32_t)divider * VERTICAL_DEBOUNCE_SAMPLES;
+    }
+
+    // Retorna a máscara dos bits que mudaram de estado nesta amostra
+    uint32_t IRAM_ATTR update(uint32_t sample) {
+        pressedEdges = 0;
+        releasedEdges = 0;
+        if (++tick < divider) return 0;
+        tick = 0;
+
+        uint32_t delta = sample ^ state;
+        cnt1 = (cnt1 ^ cnt0) & delta;
+        cnt0 = ~cnt0 & delta;
+        uint32_t toggle = delta & ~(cnt0 | cnt1);
+
+        state ^= toggle;
+        pressedEdges = toggle & state;
+        releasedEdges = toggle & ~state;
+        return toggle;
+    }
+
+    uint32_t getState() const { return state; }
+    uint32_t getPressedEdges() const { return pressedEdges; }
+    uint32_t getReleasedEdges() const { return releasedEdges; }
+};
@@ -0,0 +1,144 @@
+#pragma once
+#include <Arduino.h>
+#include <BLEDevice.h>
+#include <BLEServer.h>
+#include <BLEHIDDevice.h>
+#include <BLESecurity.h>
+#include <BLE2902.h>
+#include <HIDTypes.h>
+#include "WheelHID.h"
+#include "SharedBLEServer.h"
+
+/*
+ * GAMEPAD HID VIA BLE
+ * -------------------
+ * Mesmo relatório e descritor do gamepad USB (WheelHID.h), via HID over GATT.
+ *
+ * Ao conectar pede o menor intervalo de conexão permitido (7.5ms) com
+ * latência de periférico 0, e lê pelo evento de GAP o intervalo que o host
+ * realmente aceitou. Só sai uma notificação por intervalo: send() recusa
+ * enquanto o intervalo não passou, e o WheelController continua juntando as
+ * mudanças no mesmo relatório até o próximo evento de conexão.
+ */
+
+#define BLE_CONN_INTERVAL_MIN    6       // x1.25ms = 7.5ms
+#define BLE_CONN_INTERVAL_MAX    6
+#define BLE_CONN_LATENCY         0
+#define BLE_CONN_TIMEOUT         400     // x10ms = 4s
+#define BLE_DEFAULT_INTERVAL_US  30000   // Até o host informar o intervalo real
+
+struct WheelBLEStats {
+    uint32_t notifications;
+    uint32_t deferred;            // Relatórios adiados para o próximo intervalo
+    uint32_t notificationsPerSecond;
+    uint32_t intervalUs;          // Intervalo de conexão aceito pelo host
+    uint16_t latency;
+    uint16_t timeoutMs;
+};
+
+class WheelBLE;
+WheelBLE* wheelBleInstance = nullptr;
+
+class WheelBLE : public BLEServerCallbacks {
+private:
+    BLEHIDDevice* hid;
+    BLECharacteristic* input;
+    BLE2902* inputCccd;           // Host assinou o relatório de entrada
+    volatile bool connected;      // Alguma central conectada (pode ser só o link de dados)
+    volatile uint32_t intervalUs;
+    uint32_t lastNotify;
+
+    WheelBLEStats stats;
+    uint32_t windowStart;
+    uint32_t windowNotifications;
+
+    static void onGapEvent(esp_gap_ble_cb_event_t event, esp_ble_gap_cb_param_t* param) {
+        if (event != ESP_GAP_BLE_UPDATE_CONN_PARAMS_EVT || !wheelBleInstance) return;
+        if (param->update_conn_params.status != ESP_BT_STATUS_SUCCESS) return;
+        wheelBleInstance->intervalUs = param->update_conn_params.conn_int * 1250;
+        wheelBleInstance->stats.latency = param->update_conn_params.latency;
+        wheelBleInstance->stats.timeoutMs = param->update_conn_params.timeout * 10;
+    }
+
+public:
+    WheelBLE() :
+        hid(nullptr),
+        input(nullptr),
+        inputCccd(nullptr),
+        connected(false),
+        intervalUs(BLE_DEFAULT_INTERVAL_US),
+        lastNotify(0),
+        windowStart(0),
+        windowNotifications(0) {
+        memset(&stats, 0, sizeof(stats));
+    }
+
+    void begin(const char* name) {
+        wheelBleInstance = this;
+        // Mesmo servidor do BluetoothComm (SharedBLEServer.h)
+        BLEServer* server = sharedBleServer.get(name, this);
+        BLEDevice::setCustomGapHandler(&WheelBLE::onGapEvent);
+
+        hid = new BLEHIDDevice(server);
+        input = hid->inputReport(HID_REPORT_ID_GAMEPAD);
+        inputCccd = (BLE2902*)input->getDescriptorByUUID(BLEUUID((uint16_t)0x2902));
+        hid->manufacturer()->setValue("ESP-SimHub");
+        hid->pnp(0x02, 0xe502, 0xa111, 0x0210);
+        hid->hidInfo(0x00, 0x01);
+        hid->reportMap((uint8_t*)WHEEL_HID_REPORT_DESCRIPTOR, sizeof(WHEEL_HID_REPORT_DESCRIPTOR));
+        hid->startServices();
+
+        BLESecurity* security = new BLESecurity();
+        security->setAuthenticationMode(ESP_LE_AUTH_BOND);
+
+        sharedBleServer.setAppearance(HID_GAMEPAD);
+        sharedBleServer.addService(hid->hidService()->getUUID());
+        sharedBleServer.startAdvertising();
+    }
+
+    void onConnect(BLEServer* server, esp_ble_gatts_cb_param_t* param) override {
+        connected = true;
+        intervalUs = BLE_DEFAULT_INTERVAL_US;
+        server->updateConnParams(param->connect.remote_bda,
+            BLE_CONN_INTERVAL_MIN, BLE_CONN_INTERVAL_MAX, BLE_CONN_LATENCY, BLE_CONN_TIMEOUT);
+    }
+
+    void onDisconnect(BLEServer* server) override {
+        connected = false;
+        server->getAdvertising()->start();
+    }
+
+    // Só conta como gamepad quando o host assinou o relatório. A assinatura
+    // fica entre conexões: um host pareado não precisa refazê-la
+    bool isConnected() const {
+        return connected && inputCccd && inputCccd->getNotifications();
+    }
+
+    // Uma notificação por intervalo de conexão; false = tente no próximo ciclo
+    bool send(const WheelReport& report) {
+        if (!isConnected()) return false;
+        uint32_t now = micros();
+        if (now - lastNotify < intervalUs) {
+            stats.deferred++;
+            return false;
+        }
+        input->setValue((uint8_t*)&report, sizeof(report));
+        input->notify();
+        lastNotify = now;
+        stats.notifications++;
+        windowNotifications++;
+        return true;
+    }
+
+    const WheelBLEStats& getStats() {
+        uint32_t now = millis();
+        uint32_t elapsed = now - windowStart;
+        if (elapsed >= HID_STATS_WINDOW_MS) {
+            stats.notificationsPerSecond = windowNotifications * 1000 / elapsed;
+            windowNotifications = 0;
+            windowStart = now;
+        }
+        stats.intervalUs = intervalUs;
+        return stats;
+    }
+};
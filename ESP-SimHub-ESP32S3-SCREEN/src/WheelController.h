@@ -1,10 +1,7 @@
 #pragma once
 #include <Arduino.h>
-#include <ESP32Encoder.h>
-#include <Bounce2.h>
-#include <BleKeyboard.h>
 #include <USB.h>
-#include <USBHIDKeyboard.h>
+#include "Config.h"
 
 /*
 INSTRUÇÕES DE CONEXÃO:
@@ -47,6 +44,7 @@ SHIFT REGISTER 74HC595 (LEDs):
 - SRCLK -> GPIO 9  (CLOCK)
 - OE    -> GND
 - Saídas Q0-Q7: Conecte os LEDs através de resistores 220Ω
+- Mais de 8 LEDs: Q7' -> SER do próximo 74HC595 (RCLK e SRCLK em paralelo)
 
 JOYSTICK:
 ---------
@@ -117,31 +115,69 @@ NOTAS IMPORTANTES:
 #define ADC_RESOLUTION 12  // ESP32 tem ADC de 12 bits
 #define ADC_MAX ((1 << ADC_RESOLUTION) - 1)
 
+#include "InputEventQueue.h"
+#include "MuxScanner.h"
+#include "WheelHID.h"
+#include "WheelBLE.h"
+#include "InputMap.h"
+#include "ClutchPipeline.h"
+#include "AnalogSampler.h"
+#include "ShiftRegisterLeds.h"
+#ifdef INPUT_LATENCY_BENCHMARK
+#include "LatencyBenchmark.h"
+#endif
+
+static_assert(NUM_BUTTONS <= SR_OUTPUTS, "Cadeia de 74HC595 menor que o número de LEDs");
+static_assert(BRIGHTNESS_PIN != MUX_S0 && BRIGHTNESS_PIN != MUX_S1 &&
+              BRIGHTNESS_PIN != MUX_S2 && BRIGHTNESS_PIN != MUX_S3,
+              "O dimmer (LEDC) não pode dividir pino com a seleção dos MUX");
+static_assert(ANALOG_AVERAGE_SAMPLES == CLUTCH_OVERSAMPLE, "Soma publicada deve ter o oversampling da embreagem");
+
 class WheelController {
 private:
     // Objetos para controle dos componentes
-    ESP32Encoder encoders[NUM_ENCODERS];
-    Bounce2::Button buttons[NUM_BUTTONS];
-    Bounce2::Button paddleUp;
-    Bounce2::Button paddleDown;
-    Bounce2::Button joystickButton;
-    BleKeyboard bleKeyboard;
-    USBHIDKeyboard usbKeyboard;
+    MuxScanner muxScanner;
+    InputEventQueue inputQueue;   // Varredura (ISR) -> envio HID
+    WheelHID gamepad;
+    WheelBLE bleGamepad;          // Mesmo relatório via BLE quando não há USB
+    WheelReport report;           // Estado montado no ciclo
+    WheelReport lastSentReport;   // Último relatório aceito pelo host
+    WheelReportStats stats;
+    uint32_t windowStart = 0;
+    uint32_t windowReports = 0;
+    uint32_t windowBytes = 0;
+
+    // Detents ainda não enviados de cada encoder (+ horário, - anti-horário)
+    int16_t encoderPending[NUM_ENCODERS] = {0};
+    // Botão do pulso em andamento de cada encoder (INPUT_MAP_NONE = nenhum),
+    // para soltar o botão certo mesmo que o mapeamento mude no meio do pulso
+    uint8_t pulseTarget[NUM_ENCODERS];
+
+    // Entradas pressionadas e o botão HID que cada uma acionou, para soltar o
+    // botão certo quando o mapeamento muda com a entrada segurada
+    uint32_t heldInputs = 0;
+    uint8_t heldTarget[INPUT_BUTTON_COUNT];
+    uint32_t mapRevision = 0;
+
     bool usingBluetooth;
 
     // Estado dos componentes
     int16_t encoderValues[NUM_ENCODERS] = {0};
-    int16_t encoderLastValues[NUM_ENCODERS] = {0};
     uint8_t buttonStates[NUM_BUTTONS] = {0};
     
     int16_t joystickX = 0;
     int16_t joystickY = 0;
     uint8_t joystickPressed = 0;
     
-    int16_t clutchLeft = 0;
+    AnalogSampler analog;     // Joystick e Hall amostrados em segundo plano
+    ClutchPipeline clutch;
+    int16_t clutchLeft = 0;    // Calibradas, 0..ADC_MAX
     int16_t clutchRight = 0;
 
-    uint8_t ledStates[NUM_BUTTONS] = {0};  // Array para estado dos LEDs
+#ifdef INPUT_LATENCY_BENCHMARK
+    LatencyBenchmark latencyBenchmark;
+#endif
+    ShiftRegisterLeds buttonLeds;  // Imagem de bits dos LEDs, enviada por SPI
 
     int16_t bitePoint = 50;  // 0-100, default 50%
     bool bitePointMode = false;
@@ -149,43 +185,134 @@ private:
     bool dualClutchMode = true;  // true = modo F1, false = modo independente
 
     // Métodos auxiliares privados
-    void setMuxChannel(uint8_t channel) {
-        digitalWrite(MUX_S0, channel & 0x01);
-        digitalWrite(MUX_S1, (channel >> 1) & 0x01);
-        digitalWrite(MUX_S2, (channel >> 2) & 0x01);
-        digitalWrite(MUX_S3, (channel >> 3) & 0x01);
-        delayMicroseconds(5); // Tempo para estabilizar
+    // Só transfere quando algum LED mudou
+    void updateLEDs() {
+        buttonLeds.flush();
     }
 
-    void updateLEDs() {
-        digitalWrite(SR_LATCH, LOW);
-        for (int i = NUM_BUTTONS - 1; i >= 0; i--) {
-            digitalWrite(SR_CLOCK, LOW);
-            digitalWrite(SR_DATA, ledStates[i]);
-            digitalWrite(SR_CLOCK, HIGH);
+    void countReport(uint32_t size) {
+        stats.reports++;
+        stats.bytes += size;
+        windowReports++;
+        windowBytes += size;
+    }
+
+    // Encoders viram um toque de botão: pressionado num relatório, solto no
+    // seguinte. Um detent pendente por encoder a cada dois ciclos
+    void applyEncoderPulses() {
+        for (int i = 0; i < NUM_ENCODERS; i++) {
+            // O pulso em andamento usa o botão que acionou, não o mapeado agora
+            uint8_t target = pulseTarget[i];
+            if (target != INPUT_MAP_NONE) {
+                if (lastSentReport.getButton(target)) {
+                    report.setButton(target, false);
+                    continue;
+                }
+                if (report.getButton(target)) {
+                    continue;  // Pulso ainda não entregue: mantém até sair
+                }
+                pulseTarget[i] = INPUT_MAP_NONE;
+            }
+
+            uint8_t cw = inputMap.get(INPUT_MAP_ENCODER_CW(i));
+            uint8_t ccw = inputMap.get(INPUT_MAP_ENCODER_CCW(i));
+            if (cw == INPUT_MAP_NONE && ccw == INPUT_MAP_NONE) {
+                encoderPending[i] = 0;
+                continue;
+            }
+
+            if (encoderPending[i] > 0) {
+                pulseTarget[i] = cw;
+                encoderPending[i]--;
+            } else if (encoderPending[i] < 0) {
+                pulseTarget[i] = ccw;
+                encoderPending[i]++;
+            }
+            report.setButton(pulseTarget[i], true);
         }
-        digitalWrite(SR_LATCH, HIGH);
     }
 
-    void sendKey(uint8_t key) {
-        if (usingBluetooth && bleKeyboard.isConnected()) {
-            bleKeyboard.write(key);
-        } else if (!usingBluetooth) {
-            usbKeyboard.write(key);
+    // Um único relatório por ciclo, e só quando difere do último enviado
+    void flushReport() {
+        applyEncoderPulses();
+
+        if (memcmp(&report, &lastSentReport, sizeof(report)) == 0) {
+            stats.unchanged++;
+            return;
+        }
+        bool sent = usingBluetooth ? bleGamepad.send(report) : gamepad.send(report);
+        if (sent) {
+#ifdef INPUT_LATENCY_BENCHMARK
+            uint8_t benchButton = inputMap.get(LATENCY_BENCH_INPUT);
+            if (report.getButton(benchButton) && !lastSentReport.getButton(benchButton)) {
+                latencyBenchmark.reportQueued();
+            }
+#endif
+            lastSentReport = report;
+            countReport(sizeof(report));
+        } else {
+            stats.failed++;
         }
     }
 
+    void updateReportRate() {
+        uint32_t now = millis();
+        uint32_t elapsed = now - windowStart;
+        if (elapsed < HID_STATS_WINDOW_MS) return;
+        stats.reportsPerSecond = windowReports * 1000 / elapsed;
+        stats.bytesPerSecond = windowBytes * 1000 / elapsed;
+        windowReports = 0;
+        windowBytes = 0;
+        windowStart = now;
+    }
+
+    // Só atualiza o eixo quando a variação passa da zona morta, para o ruído
+    // do ADC não gerar um relatório por ciclo
+    bool updateAxis(uint16_t& axis, int32_t value) {
+        value = constrain(value, 0, HID_AXIS_MAX);
+        if (abs(value - (int32_t)axis) < HID_AXIS_DEADBAND && value != 0 && value != HID_AXIS_MAX) {
+            return false;
+        }
+        if (axis == value) return false;
+        axis = value;
+        return true;
+    }
+
+    WheelHat joystickHat() {
+        static const WheelHat HAT_TABLE[3][3] = {
+            {HAT_DOWN_LEFT, HAT_DOWN,     HAT_DOWN_RIGHT},
+            {HAT_LEFT,      HAT_CENTERED, HAT_RIGHT},
+            {HAT_UP_LEFT,   HAT_UP,       HAT_UP_RIGHT}
+        };
+        int dx = joystickX > ADC_MAX * 3 / 4 ? 1 : (joystickX < ADC_MAX / 4 ? -1 : 0);
+        int dy = joystickY > ADC_MAX * 3 / 4 ? 1 : (joystickY < ADC_MAX / 4 ? -1 : 0);
+        return HAT_TABLE[dy + 1][dx + 1];
+    }
+
+    // Só atualiza o estado; o envio fica para o fim do ciclo
+    void updateAnalogInputs() {
+        report.hat = joystickHat();
+        updateAxis(report.x, joystickX);
+        updateAxis(report.y, joystickY);
+        updateAxis(report.z, getClutchWithBitePoint());
+        updateAxis(report.rx, clutchLeft);
+        updateAxis(report.ry, clutchRight);
+    }
+
     void setLED(uint8_t index, bool state) {
         if (index < NUM_BUTTONS) {
-            ledStates[index] = state;
+            buttonLeds.set(index, state);
             updateLEDs();
         }
     }
 
 public:
     WheelController() : 
-        bleKeyboard("F1 Wheel"),
-        usingBluetooth(false) {}
+        usingBluetooth(false) {
+            memset(&report, 0, sizeof(report));
+            memset(&lastSentReport, 0, sizeof(lastSentReport));
+            memset(&stats, 0, sizeof(stats));
+    }
 
     void begin() {
         // Configuração dos pinos do multiplexador
@@ -194,125 +321,166 @@ public:
         pinMode(MUX_S2, OUTPUT);
         pinMode(MUX_S3, OUTPUT);
         pinMode(MUX1_SIG, INPUT);
-        pinMode(MUX2_SIG, INPUT);
-
-        // Configuração do shift register
-        pinMode(SR_DATA, OUTPUT);
-        pinMode(SR_CLOCK, OUTPUT);
-        pinMode(SR_LATCH, OUTPUT);
+        pinMode(MUX2_SIG, INPUT_PULLUP);
+        pinMode(SHIFTER_UP, INPUT_PULLUP);
+        pinMode(SHIFTER_DOWN, INPUT_PULLUP);
+        pinMode(JOY_SW, INPUT_PULLUP);
 
-        // Configuração dos paddle shifters
-        paddleUp.attach(SHIFTER_UP, INPUT_PULLUP);
-        paddleDown.attach(SHIFTER_DOWN, INPUT_PULLUP);
-        paddleUp.interval(DEBOUNCE_MS);
-        paddleDown.interval(DEBOUNCE_MS);
+        // Configuração do shift register (SPI)
+        buttonLeds.begin();
 
         // Configuração do joystick
         pinMode(JOY_X, INPUT);
         pinMode(JOY_Y, INPUT);
-        joystickButton.attach(JOY_SW, INPUT_PULLUP);
-        joystickButton.interval(DEBOUNCE_MS);
 
         // Configuração dos ADC para os sensores Hall
         analogReadResolution(ADC_RESOLUTION);
         pinMode(CLUTCH_LEFT, INPUT);
         pinMode(CLUTCH_RIGHT, INPUT);
-
-        // Inicialização dos encoders
-        for (int i = 0; i < NUM_ENCODERS; i++) {
-            encoders[i].attachFullQuad(
-                MUX1_SIG, // CLK - será multiplexado
-                MUX1_SIG  // DT - será multiplexado
-            );
-            buttons[i].attach(MUX2_SIG, INPUT_PULLUP); // Será multiplexado
-            buttons[i].interval(DEBOUNCE_MS);
-        }
-
-        // Tenta USB primeiro
-        if (ARDUINO_USB_MODE) {  // Verifica se USB está habilitado na compilação
-            USB.begin();
-            usbKeyboard.begin();
-            usingBluetooth = false;
-        } else {
-            bleKeyboard.begin();
-            usingBluetooth = true;
-        }
+        analog.begin();
+
+        // Mapeamento entradas -> botões HID salvo no NVS
+        inputMap.begin();
+        mapRevision = inputMap.getRevision();
+        memset(pulseTarget, INPUT_MAP_NONE, sizeof(pulseTarget));
+
+        // Encoders, botões, paddles e botão do joystick são lidos pela
+        // varredura do timer, que publica os eventos na inputQueue
+        muxScanner.begin(&inputQueue);
+#ifdef INPUT_LATENCY_BENCHMARK
+        latencyBenchmark.begin();
+#endif
+
+        // Gamepad USB precisa da pilha USB-OTG (ARDUINO_USB_MODE=0);
+        // sem ela o mesmo gamepad vai por BLE
+#if ARDUINO_USB_MODE == 0
+        gamepad.begin();
+        USB.begin();
+        usingBluetooth = false;
+#else
+        bleGamepad.begin("F1 Wheel");
+        usingBluetooth = true;
+#endif
     }
 
     void loop() {
-        // Atualiza estado dos encoders e seus buttons
-        for (int i = 0; i < NUM_ENCODERS; i++) {
-            // Lê encoder
-            setMuxChannel(i * 2); // Canal para CLK
-            delayMicroseconds(5);
-            setMuxChannel(i * 2 + 1); // Canal para DT
-            delayMicroseconds(5);
-            
-            encoderValues[i] = encoders[i].getCount();
-
-            // Lê button do encoder
-            setMuxChannel(i);
-            buttons[i].update();
-            buttonStates[i] = buttons[i].pressed();
-        }
-
-        // Atualiza paddle shifters
-        paddleUp.update();
-        paddleDown.update();
+        // Bordas de pressionamento valem só para este ciclo
+        memset(buttonStates, 0, sizeof(buttonStates));
+        joystickPressed = 0;
 
-        // Atualiza joystick
-        joystickX = analogRead(JOY_X);
-        joystickY = analogRead(JOY_Y);
-        joystickButton.update();
-        joystickPressed = joystickButton.pressed();
+        // Atualiza joystick (média publicada pelo AnalogSampler, sem bloquear)
+        joystickX = analog.get(ANALOG_JOY_X);
+        joystickY = analog.get(ANALOG_JOY_Y);
 
-        // Atualiza sensores Hall
-        clutchLeft = analogRead(CLUTCH_LEFT);
-        clutchRight = analogRead(CLUTCH_RIGHT);
+        // Atualiza sensores Hall (oversampling + filtro + calibração)
+        clutch.update(analog.getSum(ANALOG_CLUTCH_LEFT), analog.getSum(ANALOG_CLUTCH_RIGHT));
+        clutchLeft = clutch.getLeft();
+        clutchRight = clutch.getRight();
 
         // Atualiza LEDs
         updateLEDs();
 
+#ifdef INPUT_LATENCY_BENCHMARK
+        latencyBenchmark.loop(muxScanner);
+#endif
+
         // Processa mudanças e envia comandos
         processInputChanges();
     }
 
+    // Mapeamento alterado com entradas seguradas: solta os botões antigos
+    // antes de acionar os novos, senão o antigo ficaria preso no host
+    void applyRemap() {
+        uint32_t revision = inputMap.getRevision();
+        if (revision == mapRevision) return;
+        mapRevision = revision;
+
+        // Pulsos de encoder em andamento: o applyEncoderPulses termina a soltura
+        for (int i = 0; i < NUM_ENCODERS; i++) {
+            report.setButton(pulseTarget[i], false);
+        }
+
+        for (uint8_t id = 0; id < INPUT_BUTTON_COUNT; id++) {
+            if (heldInputs & (1UL << id)) report.setButton(heldTarget[id], false);
+        }
+        for (uint8_t id = 0; id < INPUT_BUTTON_COUNT; id++) {
+            if (!(heldInputs & (1UL << id))) continue;
+            heldTarget[id] = inputMap.get(id);
+            report.setButton(heldTarget[id], true);
+        }
+    }
+
     void processInputChanges() {
-        if (usingBluetooth && bleKeyboard.isConnected() || !usingBluetooth) {
-            // Processa encoders
-            for (int i = 0; i < NUM_ENCODERS; i++) {
-                if (encoderValues[i] != encoderLastValues[i]) {
-                    if (encoderValues[i] > encoderLastValues[i]) {
-                        sendKey(KEY_F1 + i); // Incremento
-                    } else {
-                        sendKey(KEY_F5 + i); // Decremento
+        applyRemap();
+
+        // Esvazia a fila mesmo sem conexão, para não acumular eventos velhos
+        InputEvent event;
+        while (inputQueue.pop(event)) {
+            switch (event.type) {
+                case INPUT_EVENT_ENCODER:
+                    encoderValues[event.id] += event.delta;
+                    encoderPending[event.id] += event.delta;
+                    break;
+
+                case INPUT_EVENT_PRESS:
+                case INPUT_EVENT_RELEASE: {
+                    bool pressed = event.type == INPUT_EVENT_PRESS;
+                    if (pressed && event.id < NUM_BUTTONS) buttonStates[event.id] = 1;
+                    if (pressed && event.id == INPUT_ID_JOYSTICK) joystickPressed = 1;
+                    // Entradas desativadas (INPUT_MAP_NONE) são ignoradas pelo setButton
+                    uint8_t target = inputMap.get(event.id);
+                    if (event.id < INPUT_BUTTON_COUNT) {
+                        if (pressed) {
+                            heldInputs |= 1UL << event.id;
+                            heldTarget[event.id] = target;
+                        } else {
+                            heldInputs &= ~(1UL << event.id);
+                            target = heldTarget[event.id];
+                        }
                     }
-                    encoderLastValues[i] = encoderValues[i];
+                    report.setButton(target, pressed);
+                    break;
                 }
             }
+        }
 
-            // Processa paddle shifters
-            if (paddleUp.pressed()) sendKey(KEY_PAGE_UP);
-            if (paddleDown.pressed()) sendKey(KEY_PAGE_DOWN);
+        // Joystick (hat/eixos) e embreagens
+        updateAnalogInputs();
 
-            // Processa joystick como setas direcionais
-            if (joystickX > ADC_MAX * 0.75) sendKey(KEY_RIGHT_ARROW);
-            else if (joystickX < ADC_MAX * 0.25) sendKey(KEY_LEFT_ARROW);
-            else {
-                sendKey(KEY_RIGHT_ARROW);
-                sendKey(KEY_LEFT_ARROW);
-            }
-
-            if (joystickY > ADC_MAX * 0.75) sendKey(KEY_UP_ARROW);
-            else if (joystickY < ADC_MAX * 0.25) sendKey(KEY_DOWN_ARROW);
-            else {
-                sendKey(KEY_UP_ARROW);
-                sendKey(KEY_DOWN_ARROW);
-            }
-        }
+        // Todas as mudanças do ciclo saem num único relatório
+        // (no BLE, um por intervalo de conexão)
+        flushReport();
+        updateReportRate();
     }
 
     // Getters para leitura do estado
+    // Latência (amostra -> envio) e overflow da fila de eventos
+    InputEventQueue& getInputQueue() {
+        return inputQueue;
+    }
+
+    AnalogSampler& getAnalogSampler() {
+        return analog;
+    }
+
+    // Relatórios enviados, taxa (relatórios/s) e banda (bytes/s)
+    const WheelReportStats& getReportStats() {
+        return stats;
+    }
+
+    bool isUsingBluetooth() {
+        return usingBluetooth;
+    }
+
+    bool isBluetoothConnected() {
+        return usingBluetooth && bleGamepad.isConnected();
+    }
+
+    // Intervalo de conexão aceito pelo host e notificações por segundo
+    const WheelBLEStats& getBleStats() {
+        return bleGamepad.getStats();
+    }
+
     int16_t getEncoderValue(uint8_t index) {
         return (index < NUM_ENCODERS) ? encoderValues[index] : 0;
     }
@@ -329,6 +497,16 @@ public:
 
     void setBitePoint(int16_t point) {
         bitePoint = constrain(point, 0, 100);
+        clutch.setBitePoint(bitePoint);
+    }
+
+    // Esquece o curso aprendido (ex.: após trocar um sensor)
+    void resetClutchCalibration() {
+        clutch.resetCalibration();
+    }
+
+    bool isClutchCalibrated() {
+        return clutch.getLeftChannel().isCalibrated() && clutch.getRightChannel().isCalibrated();
     }
 
     int16_t getBitePoint() {
@@ -365,7 +543,7 @@ public:
         return clutchRight;
     }
 
-    // Modifica getClutchWithBitePoint para usar o modo correto
+    // Embreagem com a curva do bite point (tabela pré-calculada no ClutchPipeline)
     int16_t getClutchWithBitePoint() {
         int16_t rawClutch;
         
@@ -376,10 +554,6 @@ public:
             rawClutch = clutchLeft;  // ou clutchRight, dependendo da preferência
         }
         
-        if (rawClutch < bitePoint) {
-            return map(rawClutch, 0, bitePoint, 0, ADC_MAX/2);
-        } else {
-            return map(rawClutch, bitePoint, 100, ADC_MAX/2, ADC_MAX);
-        }
+        return clutch.applyBitePoint(rawClutch);
     }
 }; 
\ No newline at end of file
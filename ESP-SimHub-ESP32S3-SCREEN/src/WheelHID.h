@@ -0,0 +1,147 @@
+#pragma once
+#include <Arduino.h>
+#include <USB.h>
+#include <USBHID.h>
+
+/*
+ * GAMEPAD HID DO VOLANTE
+ * ----------------------
+ * Dispositivo HID próprio na pilha USB (TinyUSB) do ESP32-S3, no lugar da
+ * emulação de teclado. Precisa de ARDUINO_USB_MODE=0 (USB-OTG).
+ *
+ * Relatório:
+ *    - 48 botões: 0-15 MUX2, 16-17 paddles, 18 joystick,
+ *                 19+ encoders (horário em 19+2i, anti-horário em 20+2i)
+ *    - Hat de 8 direções a partir do joystick
+ *    - Eixos de 12 bits: X/Y joystick, Z embreagem com bite point,
+ *                        Rx/Ry embreagens esquerda/direita
+ */
+
+#define HID_BUTTON_COUNT         48
+#define HID_BUTTON_ENCODER_BASE  19
+#define HID_AXIS_MAX             4095
+#define HID_AXIS_DEADBAND        8       // Variação mínima para reenviar um eixo
+#define HID_REPORT_TIMEOUT_MS    2       // Espera máxima pela entrega de um relatório
+#define HID_MIN_REPORT_INTERVAL_US 1000  // Até 1kHz, o intervalo de polling do endpoint
+#define HID_STATS_WINDOW_MS      1000    // Janela da taxa de relatórios
+
+// Botão HID de cada sentido de um encoder
+#define HID_BUTTON_ENCODER_CW(i)  (HID_BUTTON_ENCODER_BASE + (i) * 2)
+#define HID_BUTTON_ENCODER_CCW(i) (HID_BUTTON_ENCODER_BASE + (i) * 2 + 1)
+
+enum WheelHat : uint8_t {
+    HAT_CENTERED = 0,
+    HAT_UP,
+    HAT_UP_RIGHT,
+    HAT_RIGHT,
+    HAT_DOWN_RIGHT,
+    HAT_DOWN,
+    HAT_DOWN_LEFT,
+    HAT_LEFT,
+    HAT_UP_LEFT
+};
+
+struct __attribute__((packed)) WheelReport {
+    uint8_t buttons[HID_BUTTON_COUNT / 8];
+    uint8_t hat;
+    uint16_t x;    // Joystick
+    uint16_t y;
+    uint16_t z;    // Embreagem combinada (com bite point)
+    uint16_t rx;   // Embreagem esquerda
+    uint16_t ry;   // Embreagem direita
+
+    void setButton(uint8_t index, bool pressed) {
+        if (index >= HID_BUTTON_COUNT) return;
+        if (pressed) buttons[index >> 3] |= 1 << (index & 0x07);
+        else buttons[index >> 3] &= ~(1 << (index & 0x07));
+    }
+
+    bool getButton(uint8_t index) const {
+        if (index >= HID_BUTTON_COUNT) return false;
+        return buttons[index >> 3] & (1 << (index & 0x07));
+    }
+};
+
+static const uint8_t WHEEL_HID_REPORT_DESCRIPTOR[] = {
+    HID_USAGE_PAGE(HID_USAGE_PAGE_DESKTOP),
+    HID_USAGE(HID_USAGE_DESKTOP_GAMEPAD),
+    HID_COLLECTION(HID_COLLECTION_APPLICATION),
+        HID_REPORT_ID(HID_REPORT_ID_GAMEPAD)
+
+        // Botões
+        HID_USAGE_PAGE(HID_USAGE_PAGE_BUTTON),
+        HID_USAGE_MIN(1),
+        HID_USAGE_MAX(HID_BUTTON_COUNT),
+        HID_LOGICAL_MIN(0),
+        HID_LOGICAL_MAX(1),
+        HID_REPORT_COUNT(HID_BUTTON_COUNT),
+        HID_REPORT_SIZE(1),
+        HID_INPUT(HID_DATA | HID_VARIABLE | HID_ABSOLUTE),
+
+        // Hat (0 = centro, fora da faixa lógica)
+        HID_USAGE_PAGE(HID_USAGE_PAGE_DESKTOP),
+        HID_USAGE(HID_USAGE_DESKTOP_HAT_SWITCH),
+        HID_LOGICAL_MIN(1),
+        HID_LOGICAL_MAX(8),
+        HID_PHYSICAL_MIN(0),
+        HID_PHYSICAL_MAX_N(315, 2),
+        HID_REPORT_COUNT(1),
+        HID_REPORT_SIZE(8),
+        HID_INPUT(HID_DATA | HID_VARIABLE | HID_ABSOLUTE | HID_NULL_STATE),
+
+        // Eixos
+        HID_USAGE(HID_USAGE_DESKTOP_X),
+        HID_USAGE(HID_USAGE_DESKTOP_Y),
+        HID_USAGE(HID_USAGE_DESKTOP_Z),
+        HID_USAGE(HID_USAGE_DESKTOP_RX),
+        HID_USAGE(HID_USAGE_DESKTOP_RY),
+        HID_LOGICAL_MIN(0),
+        HID_LOGICAL_MAX_N(HID_AXIS_MAX, 2),
+        HID_PHYSICAL_MIN(0),
+        HID_PHYSICAL_MAX_N(HID_AXIS_MAX, 2),
+        HID_REPORT_COUNT(5),
+        HID_REPORT_SIZE(16),
+        HID_INPUT(HID_DATA | HID_VARIABLE | HID_ABSOLUTE),
+    HID_COLLECTION_END
+};
+
+// Relatórios enviados (USB ou BLE) e taxa medida na última janela
+struct WheelReportStats {
+    uint32_t reports;
+    uint32_t bytes;
+    uint32_t unchanged;         // Ciclos com estado igual ao último enviado
+    uint32_t failed;            // Envios não aceitos (repete no ciclo seguinte) ou teclas descartadas
+    uint32_t reportsPerSecond;
+    uint32_t bytesPerSecond;
+};
+
+class WheelHID : public USBHIDDevice {
+private:
+    USBHID hid;
+
+public:
+    WheelHID() {
+        static bool initialized = false;
+        if (!initialized) {
+            initialized = true;
+            hid.addDevice(this, sizeof(WHEEL_HID_REPORT_DESCRIPTOR));
+        }
+    }
+
+    void begin() {
+        hid.begin();
+    }
+
+    uint16_t _onGetDescriptor(uint8_t* buffer) override {
+        memcpy(buffer, WHEEL_HID_REPORT_DESCRIPTOR, sizeof(WHEEL_HID_REPORT_DESCRIPTOR));
+        return sizeof(WHEEL_HID_REPORT_DESCRIPTOR);
+    }
+
+    bool ready() {
+        return hid.ready();
+    }
+
+    bool send(const WheelReport& report) {
+        return hid.SendReport(HID_REPORT_ID_GAMEPAD, &report, sizeof(report), HID_REPORT_TIMEOUT_MS);
+    }
+};
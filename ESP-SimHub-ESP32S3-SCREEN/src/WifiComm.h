@@ -15,8 +15,9 @@ private:
 public:
     WifiComm(Arduino_GFX* gfx) : display(gfx) {
         bridge = new TcpSerialBridge2(BRIDGE_PORT);
-        outStream = new FullLoopbackStream(1024);
-        inStream = new FullLoopbackStream(1024);
+        outStream = new FullLoopbackStream(BRIDGE_TX_BUFFER_SIZE);
+        // Escrito pela task do AsyncTCP, lido pelo loop
+        inStream = new FullLoopbackStream(BRIDGE_RX_BUFFER_SIZE, true);
         connected = false;
     }
 
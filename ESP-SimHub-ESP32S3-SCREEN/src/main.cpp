@@ -1,8 +1,12 @@
 #include <Arduino.h>
 #include "CommManager.h"
+#include "CommStream.h"
 #include <Arduino_GFX_Library.h>
 #include "LedManager.h"
 #include "WheelController.h"
+#ifdef LED_BENCHMARK
+#include "LedBenchmark.h"
+#endif
 
 // Variáveis para dados do SimHub
 int currentRPM = 0;
@@ -44,8 +48,23 @@ bool blueFlag = false;
 #include <ECrowneWifi.h>
 #include <FullLoopbackStream.h>
 
-FullLoopbackStream outgoingStream;
-FullLoopbackStream incomingStream;
+// Criados no setup(): construtores globais rodam antes do psramInit() e o
+// buffer de recepção cairia na RAM interna
+FullLoopbackStream *outgoingStream;
+FullLoopbackStream *incomingStream;
+
+#else
+
+// O protocolo do SimHub (ARQSerial) fala pelo transporte ativo do CommManager
+CommStream commStream;
+
+#define FlowSerialBegin [](unsigned long baud) {}
+#define FlowSerialFlush commStream.flush
+#define StreamRead commStream.read
+#define StreamAvailable commStream.available
+#define StreamFlush commStream.flush
+#define StreamWrite commStream.write
+#define StreamPrint commStream.print
 
 #endif // INCLUDE_WIFI
 
@@ -63,6 +82,8 @@ void idle(bool critical);
 // Don't change this
 #define VERSION 'j'
 
+LedManager ledManager;
+
 #include <SHCommands.h>
 
 // Configuração do display para WT32-SC01 Plus
@@ -83,12 +104,15 @@ Arduino_GFX *gfx = new Arduino_ST7796(
 
 CommManager commManager(gfx);
 
-LedManager ledManager;
 WheelController wheelController;
 
-// Variável para controle de tempo
+// Variáveis para controle de tempo
 unsigned long lastWheelUpdate = 0;
-const unsigned long WHEEL_UPDATE_INTERVAL = 10; // 10ms = 100Hz
+const unsigned long WHEEL_UPDATE_INTERVAL = 10; // 10ms = 100Hz (LEDs dos botões)
+unsigned long lastWheelReport = 0;
+const unsigned long WHEEL_REPORT_INTERVAL_US = HID_MIN_REPORT_INTERVAL_US; // 1ms = 1kHz (relatórios HID, WheelHID.h)
+unsigned long lastBleStats = 0;
+const unsigned long BLE_STATS_INTERVAL = 1000; // Linha de status do gamepad BLE
 
 void setup(void)
 {
@@ -104,15 +128,23 @@ void setup(void)
 #endif
 
 #if INCLUDE_WIFI
-	ECrowneWifi::setup(&outgoingStream, &incomingStream, gfx);
+	outgoingStream = new FullLoopbackStream(BRIDGE_TX_BUFFER_SIZE);
+	incomingStream = new FullLoopbackStream(BRIDGE_RX_BUFFER_SIZE, true);
+	ECrowneWifi::setup(outgoingStream, incomingStream, gfx);
 #endif
 
   gfx->begin();
   gfx->fillScreen(BLACK);
   
   commManager.setup();
+#if !INCLUDE_WIFI
+  commStream.begin(&commManager);
+#endif
 
   ledManager.begin();
+#ifdef LED_BENCHMARK
+  runLedBenchmark(ledManager, Serial);
+#endif
   ledManager.setMaxRPM(9000);  // Ajuste para o RPM máximo do seu carro
 
   // Inicializa o controlador do volante
@@ -143,6 +175,7 @@ void loop()
 				case '1': Command_Hello(); break;
 				case '0': Command_Features(); break;
 				case '4': Command_RGBLEDSCount(); break;
+				case '6': Command_RGBLEDSData(); break;
 				case 'X': {
 					String xaction = FlowSerialReadStringUntil(' ', '\n');
 					if (xaction == F("list")) Command_ExpandedCommandsList();
@@ -168,14 +201,32 @@ void loop()
 
   commManager.loop();
 
-  // Atualização do volante em intervalo fixo
+  // Entradas do volante a até 1kHz; só gera relatório quando algo muda
+  unsigned long currentMicros = micros();
+  if (currentMicros - lastWheelReport >= WHEEL_REPORT_INTERVAL_US) {
+    lastWheelReport = currentMicros;
+    wheelController.loop();
+  }
+
+  // LEDs dos botões em intervalo fixo
   unsigned long currentMillis = millis();
   if (currentMillis - lastWheelUpdate >= WHEEL_UPDATE_INTERVAL) {
     lastWheelUpdate = currentMillis;
-    wheelController.loop();
-    
+
     // Usar LedManager para controlar todos os LEDs
     ledManager.handleWheelEvents(drsEnabled, yellowFlag, blueFlag);
+
+  }
+
+  // Intervalo de conexão aceito pelo host e notificações/s no rodapé
+  if (wheelController.isBluetoothConnected() && currentMillis - lastBleStats >= BLE_STATS_INTERVAL) {
+    lastBleStats = currentMillis;
+    const WheelBLEStats& bleStats = wheelController.getBleStats();
+    gfx->fillRect(0, PIXEL_HEIGHT - 10, PIXEL_WIDTH, 10, BLACK);
+    gfx->setCursor(0, PIXEL_HEIGHT - 10);
+    gfx->setTextColor(WHITE);
+    gfx->printf("BLE %u.%02ums lat %u  %u notif/s",
+      bleStats.intervalUs / 1000, bleStats.intervalUs % 1000 / 10, bleStats.latency, bleStats.notificationsPerSecond);
   }
 }
 
@@ -0,0 +1,33 @@
+#pragma once
+
+// PCA9685 stand-in for the native tests: counts the I2C channel writes (per
+//  driver and across all of them) and keeps the last value of each channel.
+
+#include <Arduino.h>
+
+class Adafruit_PWMServoDriver
+{
+public:
+    Adafruit_PWMServoDriver(uint8_t address = 0x40) : address(address) {}
+
+    bool begin() { return true; }
+    void setPWMFreq(float frequency) { this->frequency = frequency; }
+
+    void setPWM(uint8_t channel, uint16_t on, uint16_t off)
+    {
+        writes++;
+        totalWrites++;
+        if (channel < 16)
+            channels[channel] = off;
+    }
+
+    uint8_t address;
+    float frequency = 0;
+    uint32_t writes = 0;
+    uint16_t channels[16] = {};
+
+    // drivers owned by the code under test are out of reach, this one is not
+    inline static uint32_t totalWrites = 0;
+};
+
+typedef Adafruit_PWMServoDriver Adafruit_PWM_Servo_Driver;
@@ -0,0 +1,65 @@
+#pragma once
+
+// FastLED stand-in for the native tests: keeps the pixel type and records what
+//  show() would have sent, so a replay can be checked frame by frame.
+
+#include <Arduino.h>
+#include <vector>
+
+struct CRGB
+{
+    uint8_t r, g, b;
+
+    enum HTMLColorCode : uint32_t
+    {
+        Black = 0x000000,
+        Blue = 0x0000FF,
+        Green = 0x008000,
+        Purple = 0x800080,
+        Red = 0xFF0000,
+        Yellow = 0xFFFF00,
+    };
+
+    CRGB() : r(0), g(0), b(0) {}
+    CRGB(uint8_t red, uint8_t green, uint8_t blue) : r(red), g(green), b(blue) {}
+    CRGB(HTMLColorCode code) : r(code >> 16), g(code >> 8), b(code) {}
+
+    bool operator==(const CRGB &other) const { return r == other.r && g == other.g && b == other.b; }
+    bool operator!=(const CRGB &other) const { return !(*this == other); }
+};
+
+enum EOrder { RGB, GRB };
+
+template <uint8_t DATA_PIN, EOrder RGB_ORDER>
+class WS2812B {};
+
+inline void fill_solid(CRGB *leds, int count, const CRGB &color)
+{
+    for (int i = 0; i < count; i++)
+        leds[i] = color;
+}
+
+class CFastLED
+{
+public:
+    template <template <uint8_t, EOrder> class CHIPSET, uint8_t DATA_PIN, EOrder RGB_ORDER>
+    void addLeds(CRGB *data, int count)
+    {
+        leds = data;
+        ledCount = count;
+    }
+
+    void setBrightness(uint8_t value) { brightness = value; }
+
+    // every frame that would have gone out on the data pin
+    void show() { frames.emplace_back(leds, leds + ledCount); }
+
+    void reset() { frames.clear(); }
+
+    CRGB *leds = nullptr;
+    int ledCount = 0;
+    uint8_t brightness = 255;
+    std::vector<std::vector<CRGB>> frames;
+};
+
+inline CFastLED FastLED;
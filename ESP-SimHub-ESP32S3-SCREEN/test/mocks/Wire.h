@@ -0,0 +1,3 @@
+#pragma once
+
+// I2C is only reached through the PCA9685 stand-in in the native tests
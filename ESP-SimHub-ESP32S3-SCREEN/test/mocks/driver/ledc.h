@@ -0,0 +1,27 @@
+#pragma once
+
+// LEDC stand-in for the native tests: keeps the last duty given to each channel
+
+#include <Arduino.h>
+
+typedef enum { LEDC_LOW_SPEED_MODE } ledc_mode_t;
+typedef enum { LEDC_CHANNEL_0, LEDC_CHANNEL_MAX = 8 } ledc_channel_t;
+typedef enum { LEDC_FADE_NO_WAIT, LEDC_FADE_WAIT_DONE } ledc_fade_mode_t;
+
+inline uint32_t mockLedcDuty[LEDC_CHANNEL_MAX] = {};
+
+inline double ledcSetup(uint8_t, double frequency, uint8_t) { return frequency; }
+inline void ledcAttachPin(uint8_t, uint8_t) {}
+inline int ledc_fade_func_install(int) { return 0; }
+
+inline int ledc_set_duty_and_update(ledc_mode_t, ledc_channel_t channel, uint32_t duty, uint32_t)
+{
+    mockLedcDuty[channel] = duty;
+    return 0;
+}
+
+inline int ledc_set_fade_time_and_start(ledc_mode_t, ledc_channel_t channel, uint32_t duty, uint32_t, ledc_fade_mode_t)
+{
+    mockLedcDuty[channel] = duty;
+    return 0;
+}
@@ -0,0 +1,193 @@
+// Host replay of the LED pipeline: LedManager runs unchanged against the FastLED,
+//  PCA9685 and LEDC stand-ins in test/mocks, fed with the same synthetic telemetry
+//  as the on-device benchmark (src/LedReplay.h).
+
+#define LED_BENCHMARK
+#define LED_FRAME_RECORDER
+
+#include <unity.h>
+#include <chrono>
+#include "LedReplay.h"
+
+// FNV-1a over every frame sent to the strip during the full replay. Update it
+//  only for an intended change in what the LEDs show.
+#define LED_REPLAY_GOLDEN_HASH 0xAE103ED7
+
+// Ceilings for the replay, at today's figures: the replay is deterministic, so
+//  any rise is a behaviour change (shows skipped as identical out of the 2000
+//  updates, PCA9685 writes per second at the loop rate)
+#define LED_REPLAY_MAX_REDUNDANT_SHOWS  1872
+#define LED_REPLAY_MAX_I2C_PER_SECOND   300
+
+static LedManager *ledManager;
+
+void setUp(void)
+{
+    FastLED.reset();
+    ledManager = new LedManager();
+    ledManager->begin();
+    ledManager->setMaxRPM(LED_REPLAY_MAX_RPM);
+    ledManager->resetStats();
+    ledManager->clearRecordedFrames();
+    FastLED.reset();
+    Adafruit_PWMServoDriver::totalWrites = 0;
+}
+
+void tearDown(void)
+{
+    delete ledManager;
+}
+
+static uint32_t hashFrames()
+{
+    uint32_t hash = 2166136261u;
+    for (const std::vector<CRGB> &frame : FastLED.frames)
+    {
+        for (const CRGB &led : frame)
+        {
+            const uint8_t bytes[3] = {led.r, led.g, led.b};
+            for (uint8_t value : bytes)
+            {
+                hash ^= value;
+                hash *= 16777619u;
+            }
+        }
+    }
+    return hash;
+}
+
+static void replay()
+{
+    for (uint32_t frame = 0; frame < LED_REPLAY_FRAMES; frame++)
+    {
+        ledReplayStep(*ledManager, frame);
+    }
+}
+
+void test_replay_matches_golden_frames(void)
+{
+    replay();
+    char message[48];
+    snprintf(message, sizeof(message), "replay hash 0x%08X", hashFrames());
+    TEST_MESSAGE(message);
+    TEST_ASSERT_EQUAL_HEX32(LED_REPLAY_GOLDEN_HASH, hashFrames());
+}
+
+void test_replay_never_sends_a_repeated_frame(void)
+{
+    replay();
+    TEST_ASSERT_EQUAL_UINT32(FastLED.frames.size(), ledManager->getStats().shows);
+    for (size_t i = 1; i < FastLED.frames.size(); i++)
+    {
+        TEST_ASSERT_TRUE(FastLED.frames[i] != FastLED.frames[i - 1]);
+    }
+    // the telemetry changes at most every 5 loops, so most updates must be skipped
+    TEST_ASSERT_LESS_THAN_UINT32(LED_REPLAY_FRAMES / 4, ledManager->getStats().shows);
+}
+
+// Same figures the on-device LedBenchmark.h prints, from the host run
+void test_replay_reports_update_cost_and_bus_traffic(void)
+{
+    uint64_t totalUs = 0;
+    uint64_t maxUs = 0;
+    for (uint32_t frame = 0; frame < LED_REPLAY_FRAMES; frame++)
+    {
+        auto start = std::chrono::steady_clock::now();
+        ledReplayStep(*ledManager, frame);
+        uint64_t us = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start).count();
+        totalUs += us;
+        if (us > maxUs)
+            maxUs = us;
+    }
+
+    const LedStats &stats = ledManager->getStats();
+    uint32_t i2cPerSecond = Adafruit_PWMServoDriver::totalWrites * LED_REPLAY_LOOP_HZ / LED_REPLAY_FRAMES;
+    char message[160];
+    snprintf(message, sizeof(message), "update: avg %u us, max %u us | shows: %u sent, %u redundant | i2c: %u writes (%u redundant), %u/s @%uHz",
+             (uint32_t)(totalUs / LED_REPLAY_FRAMES), (uint32_t)maxUs, stats.shows, stats.redundantShows,
+             Adafruit_PWMServoDriver::totalWrites, stats.redundantI2cWrites, i2cPerSecond, LED_REPLAY_LOOP_HZ);
+    TEST_MESSAGE(message);
+
+    // the counters in LedManager match what reached the bus
+    TEST_ASSERT_EQUAL_UINT32(stats.i2cWrites, Adafruit_PWMServoDriver::totalWrites);
+    TEST_ASSERT_EQUAL_UINT32(LED_REPLAY_FRAMES, stats.shows + stats.redundantShows);
+    TEST_ASSERT_TRUE(stats.redundantShows <= LED_REPLAY_MAX_REDUNDANT_SHOWS);
+    TEST_ASSERT_TRUE(i2cPerSecond <= LED_REPLAY_MAX_I2C_PER_SECOND);
+}
+
+void test_full_rpm_lights_the_colour_bands(void)
+{
+    ledManager->updateRPM(LED_REPLAY_MAX_RPM);
+    ledManager->clearFlags();
+    ledManager->update();
+
+    const std::vector<CRGB> &frame = FastLED.frames.back();
+    TEST_ASSERT_TRUE(frame[0] == CRGB(CRGB::Green));
+    TEST_ASSERT_TRUE(frame[7] == CRGB(CRGB::Green));
+    TEST_ASSERT_TRUE(frame[8] == CRGB(CRGB::Yellow));
+    TEST_ASSERT_TRUE(frame[12] == CRGB(CRGB::Yellow));
+    TEST_ASSERT_TRUE(frame[13] == CRGB(CRGB::Red));
+    // with no flag the RPM bar is redrawn last, over the DRS pair
+    TEST_ASSERT_TRUE(frame[15] == CRGB(CRGB::Red));
+}
+
+void test_simhub_frame_owns_the_strip_until_timeout(void)
+{
+    CRGB *leds = ledManager->beginSimHubFrame();
+    fill_solid(leds, ledManager->getLedCount(), CRGB(1, 2, 3));
+    ledManager->endSimHubFrame();
+    TEST_ASSERT_EQUAL_UINT32(1, FastLED.frames.size());
+
+    ledManager->updateRPM(LED_REPLAY_MAX_RPM);
+    ledManager->update();
+    TEST_ASSERT_EQUAL_UINT32(1, FastLED.frames.size());
+
+    mockAdvanceMs(SIMHUB_FRAME_TIMEOUT_MS);
+    ledManager->updateRPM(LED_REPLAY_MAX_RPM);
+    ledManager->update();
+    TEST_ASSERT_EQUAL_UINT32(2, FastLED.frames.size());
+    TEST_ASSERT_TRUE(FastLED.frames.back()[0] == CRGB(CRGB::Green));
+}
+
+void test_recorder_keeps_one_frame_per_change(void)
+{
+    replay();
+    uint32_t recorded = ledManager->getRecordedFrameCount();
+    // every strip change is recorded, plus the loops where only a button changed
+    TEST_ASSERT_TRUE(recorded >= ledManager->getStats().shows);
+    TEST_ASSERT_TRUE(recorded <= LED_REPLAY_FRAMES);
+
+    // an idle loop (same telemetry, same button LEDs) records nothing
+    ledReplayStep(*ledManager, LED_REPLAY_FRAMES - 1);
+    ledReplayStep(*ledManager, LED_REPLAY_FRAMES - 1);
+    recorded = ledManager->getRecordedFrameCount();
+    ledReplayStep(*ledManager, LED_REPLAY_FRAMES - 1);
+    TEST_ASSERT_EQUAL_UINT32(recorded, ledManager->getRecordedFrameCount());
+}
+
+void test_brightness_profiles_set_the_dimmer_duty(void)
+{
+    const uint32_t fullDuty = (1 << BRIGHTNESS_PWM_BITS) - 1;
+    const ledc_channel_t channel = (ledc_channel_t)(BRIGHTNESS_LEDC_CHANNEL % LEDC_CHANNEL_MAX);
+
+    ledManager->setBrightnessProfile(BRIGHTNESS_PROFILE_NIGHT);
+    TEST_ASSERT_EQUAL_UINT32(BRIGHTNESS_NIGHT_MAX * fullDuty / 255, mockLedcDuty[channel]);
+
+    ledManager->setBrightnessProfile(BRIGHTNESS_PROFILE_DAY);
+    TEST_ASSERT_EQUAL_UINT32(BRIGHTNESS_DAY_MAX * fullDuty / 255, mockLedcDuty[channel]);
+    // the dimmer never re-sends the pixels
+    TEST_ASSERT_EQUAL_UINT32(0, FastLED.frames.size());
+}
+
+int main(int argc, char **argv)
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_replay_matches_golden_frames);
+    RUN_TEST(test_replay_never_sends_a_repeated_frame);
+    RUN_TEST(test_replay_reports_update_cost_and_bus_traffic);
+    RUN_TEST(test_full_rpm_lights_the_colour_bands);
+    RUN_TEST(test_simhub_frame_owns_the_strip_until_timeout);
+    RUN_TEST(test_recorder_keeps_one_frame_per_change);
+    RUN_TEST(test_brightness_profiles_set_the_dimmer_duty);
+    return UNITY_END();
+}
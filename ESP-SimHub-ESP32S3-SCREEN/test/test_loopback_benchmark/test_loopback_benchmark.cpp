@@ -0,0 +1,153 @@
+// Host benchmark of lib/FullLoopbackStream against the stream it replaced: the
+//  LoopbackStream library (byte ring with pos/size) wrapped by the old
+//  FullLoopbackStream, whose bulk write looped over write(uint8_t) and whose reads
+//  fell back to Stream::readBytes, one timedRead per byte.
+
+#include <unity.h>
+#include <FullLoopbackStream.h>
+#include <chrono>
+
+#define LOOPBACK_BENCHMARK_BYTES     (4UL * 1024 * 1024)
+#define LOOPBACK_BENCHMARK_BUFFER    1024   // size WifiComm uses
+#define LOOPBACK_BENCHMARK_MAX_CHUNK 300
+#define LOOPBACK_POLL_TIMEOUT_MS     20
+
+// LoopbackStream as shipped by the library, and the old wrapper around it
+class BaselineLoopbackStream : public Stream
+{
+public:
+    BaselineLoopbackStream(uint16_t buffer_size) : buffer((uint8_t *)malloc(buffer_size)), buffer_size(buffer_size), pos(0), size(0) {}
+    ~BaselineLoopbackStream() { free(buffer); }
+
+    size_t write(uint8_t v) override
+    {
+        if (size == buffer_size)
+            return 0;
+        int p = pos + size;
+        if (p >= buffer_size)
+            p -= buffer_size;
+        buffer[p] = v;
+        size++;
+        return 1;
+    }
+
+    size_t write(const uint8_t *data, size_t length) override
+    {
+        size_t n = 0;
+        while (length--)
+        {
+            if (write(*data++))
+                n++;
+            else
+                break;
+        }
+        return n;
+    }
+    using Print::write;
+
+    int availableForWrite() override { return buffer_size - size; }
+    int available() override { return size; }
+
+    int read() override
+    {
+        if (size == 0)
+            return -1;
+        int ret = buffer[pos];
+        pos++;
+        size--;
+        if (pos == buffer_size)
+            pos = 0;
+        return ret;
+    }
+
+    int peek() override { return size == 0 ? -1 : buffer[pos]; }
+
+private:
+    uint8_t *buffer;
+    uint16_t buffer_size;
+    uint16_t pos, size;
+};
+
+void setUp(void) {}
+void tearDown(void) {}
+
+struct BenchmarkPass {
+    uint64_t elapsedUs;
+    uint32_t checksum;
+};
+
+// Same varied chunks through either stream, so the ring wraps at every offset
+template <typename StreamType>
+static BenchmarkPass runPass(StreamType &stream)
+{
+    uint8_t chunk[LOOPBACK_BENCHMARK_MAX_CHUNK];
+    uint8_t out[LOOPBACK_BENCHMARK_MAX_CHUNK];
+    for (size_t i = 0; i < sizeof(chunk); i++)
+        chunk[i] = i * 7;
+
+    BenchmarkPass pass = {0, 0};
+    uint32_t moved = 0;
+    uint32_t step = 0;
+    auto start = std::chrono::steady_clock::now();
+
+    while (moved < LOOPBACK_BENCHMARK_BYTES)
+    {
+        size_t size = (step++ * 37) % LOOPBACK_BENCHMARK_MAX_CHUNK + 1;
+        stream.write(chunk, size);
+        size_t n = stream.readBytes(out, size);
+        for (size_t i = 0; i < n; i++)
+            pass.checksum = pass.checksum * 31 + out[i];
+        moved += size;
+    }
+
+    pass.elapsedUs = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start).count();
+    return pass;
+}
+
+void test_bulk_stream_beats_the_baseline(void)
+{
+    BaselineLoopbackStream baseline(LOOPBACK_BENCHMARK_BUFFER);
+    FullLoopbackStream stream(LOOPBACK_BENCHMARK_BUFFER);
+    BenchmarkPass before = runPass(baseline);
+    BenchmarkPass after = runPass(stream);
+
+    char message[128];
+    snprintf(message, sizeof(message), "%lu bytes: baseline %llu us, bulk %llu us, x%.1f",
+             LOOPBACK_BENCHMARK_BYTES, (unsigned long long)before.elapsedUs, (unsigned long long)after.elapsedUs,
+             after.elapsedUs ? (double)before.elapsedUs / after.elapsedUs : 0.0);
+    TEST_MESSAGE(message);
+
+    TEST_ASSERT_EQUAL_HEX32(before.checksum, after.checksum);
+    TEST_ASSERT_LESS_THAN_UINT32(before.elapsedUs, after.elapsedUs);
+}
+
+// WifiComm polls with a buffer larger than what arrived: the baseline waits out
+//  the stream timeout on the missing bytes, the bulk read returns what there is
+void test_short_read_does_not_wait_for_the_timeout(void)
+{
+    const uint8_t data[10] = {1, 2, 3, 4, 5, 6, 7, 8, 9, 10};
+    uint8_t out[64];
+
+    BaselineLoopbackStream baseline(LOOPBACK_BENCHMARK_BUFFER);
+    baseline.setTimeout(LOOPBACK_POLL_TIMEOUT_MS);
+    baseline.write(data, sizeof(data));
+    unsigned long start = millis();
+    TEST_ASSERT_EQUAL_UINT32(sizeof(data), baseline.readBytes(out, sizeof(out)));
+    TEST_ASSERT_TRUE(millis() - start >= LOOPBACK_POLL_TIMEOUT_MS);
+
+    FullLoopbackStream stream(LOOPBACK_BENCHMARK_BUFFER);
+    stream.setTimeout(LOOPBACK_POLL_TIMEOUT_MS);
+    stream.write(data, sizeof(data));
+    start = millis();
+    TEST_ASSERT_EQUAL_UINT32(sizeof(data), stream.readBytes(out, sizeof(out)));
+    TEST_ASSERT_EQUAL_MEMORY(data, out, sizeof(data));
+    TEST_ASSERT_TRUE(millis() - start < LOOPBACK_POLL_TIMEOUT_MS);
+}
+
+int main(int argc, char **argv)
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_bulk_stream_beats_the_baseline);
+    RUN_TEST(test_short_read_does_not_wait_for_the_timeout);
+    return UNITY_END();
+}
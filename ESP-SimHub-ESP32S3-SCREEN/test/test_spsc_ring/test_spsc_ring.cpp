@@ -0,0 +1,178 @@
+// Host tests for lib/SpscRingBuffer: single-threaded edge cases, then a producer
+//  thread and a consumer thread pushing a pseudorandom byte sequence through a
+//  small ring in random-sized chunks, so every wrap position is crossed while
+//  both indices move. Any lost, duplicated or reordered byte breaks the sequence.
+
+#include <unity.h>
+#include <SpscRingBuffer.h>
+#include <atomic>
+#include <thread>
+
+#define SPSC_STRESS_BYTES        (16UL * 1024 * 1024)
+#define SPSC_STRESS_RING_SIZE    4096
+#define SPSC_STRESS_MAX_CHUNK    700
+
+void setUp(void) {}
+void tearDown(void) {}
+
+static inline uint32_t xorshift(uint32_t &state)
+{
+    state ^= state << 13;
+    state ^= state >> 17;
+    state ^= state << 5;
+    return state;
+}
+
+void test_capacity_rounds_up_to_a_power_of_two(void)
+{
+    SpscRingBuffer ring(1000, true);
+    TEST_ASSERT_EQUAL_UINT32(1024, ring.capacity());
+    // no PSRAM off the ESP32: the request falls back to the heap
+    TEST_ASSERT_FALSE(ring.isInPsram());
+    TEST_ASSERT_EQUAL_UINT32(1024, ring.space());
+}
+
+void test_overflow_is_dropped_and_counted(void)
+{
+    SpscRingBuffer ring(8);
+    const uint8_t data[12] = {1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12};
+    TEST_ASSERT_EQUAL_UINT32(8, ring.write(data, sizeof(data)));
+    TEST_ASSERT_EQUAL_UINT32(0, ring.write(data, 1));
+    TEST_ASSERT_EQUAL_UINT32(5, ring.getOverflowBytes());
+    TEST_ASSERT_EQUAL_UINT32(2, ring.getOverflowCount());
+
+    uint8_t out[12];
+    TEST_ASSERT_EQUAL_UINT32(8, ring.read(out, sizeof(out)));
+    TEST_ASSERT_EQUAL_MEMORY(data, out, 8);
+    TEST_ASSERT_EQUAL_INT(-1, ring.read());
+}
+
+void test_contiguous_segments_split_at_the_wrap(void)
+{
+    SpscRingBuffer ring(8);
+    const uint8_t data[8] = {1, 2, 3, 4, 5, 6, 7, 8};
+    uint8_t out[8];
+    ring.write(data, 6);
+    ring.read(out, 6);
+    ring.write(data, 5);   // 2 bytes before the wrap, 3 after
+
+    const uint8_t *segment;
+    TEST_ASSERT_EQUAL_UINT32(2, ring.peekContiguous(&segment));
+    TEST_ASSERT_EQUAL_MEMORY(data, segment, 2);
+    ring.consume(2);
+    TEST_ASSERT_EQUAL_UINT32(3, ring.peekContiguous(&segment));
+    TEST_ASSERT_EQUAL_MEMORY(data + 2, segment, 3);
+    ring.consume(10);      // never past what was written
+    TEST_ASSERT_EQUAL_UINT32(0, ring.available());
+}
+
+struct StressResult {
+    uint32_t received;
+    uint32_t errors;
+};
+
+static void produce(SpscRingBuffer &ring)
+{
+    uint32_t sequence = 0x1234567;
+    uint32_t sizes = 0x89abcdef;
+    uint8_t chunk[SPSC_STRESS_MAX_CHUNK];
+    uint32_t sent = 0;
+
+    while (sent < SPSC_STRESS_BYTES)
+    {
+        size_t size = xorshift(sizes) % SPSC_STRESS_MAX_CHUNK + 1;
+        if (size > SPSC_STRESS_BYTES - sent)
+            size = SPSC_STRESS_BYTES - sent;
+        for (size_t i = 0; i < size; i++)
+            chunk[i] = xorshift(sequence);
+
+        // writes only what fits, so nothing counts as overflow
+        size_t offset = 0;
+        while (offset < size)
+        {
+            size_t room = ring.space();
+            if (room == 0)
+            {
+                std::this_thread::yield();
+                continue;
+            }
+            size_t n = size - offset < room ? size - offset : room;
+            offset += ring.write(chunk + offset, n);
+        }
+        sent += size;
+    }
+}
+
+// zeroCopy consumes through peekContiguous/consume, as the TCP flush does
+static StressResult consume(SpscRingBuffer &ring, bool zeroCopy)
+{
+    uint32_t sequence = 0x1234567;
+    uint32_t sizes = 0x13579bdf;
+    uint8_t chunk[SPSC_STRESS_MAX_CHUNK];
+    StressResult result = {0, 0};
+
+    while (result.received < SPSC_STRESS_BYTES)
+    {
+        size_t wanted = xorshift(sizes) % SPSC_STRESS_MAX_CHUNK + 1;
+        const uint8_t *data = chunk;
+        size_t n;
+        if (zeroCopy)
+        {
+            n = ring.peekContiguous(&data);
+            if (n > wanted)
+                n = wanted;
+        }
+        else
+        {
+            n = ring.read(chunk, wanted);
+        }
+        if (n == 0)
+        {
+            std::this_thread::yield();
+            continue;
+        }
+        for (size_t i = 0; i < n; i++)
+        {
+            if (data[i] != (uint8_t)xorshift(sequence))
+                result.errors++;
+        }
+        if (zeroCopy)
+            ring.consume(n);
+        result.received += n;
+    }
+    return result;
+}
+
+static void runStress(bool zeroCopy)
+{
+    SpscRingBuffer ring(SPSC_STRESS_RING_SIZE);
+    std::thread producer(produce, std::ref(ring));
+    StressResult result = consume(ring, zeroCopy);
+    producer.join();
+
+    TEST_ASSERT_EQUAL_UINT32(SPSC_STRESS_BYTES, result.received);
+    TEST_ASSERT_EQUAL_UINT32(0, result.errors);
+    TEST_ASSERT_EQUAL_UINT32(0, ring.getOverflowBytes());
+    TEST_ASSERT_EQUAL_UINT32(0, ring.available());
+}
+
+void test_two_threads_copying_reads(void)
+{
+    runStress(false);
+}
+
+void test_two_threads_zero_copy_reads(void)
+{
+    runStress(true);
+}
+
+int main(int argc, char **argv)
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_capacity_rounds_up_to_a_power_of_two);
+    RUN_TEST(test_overflow_is_dropped_and_counted);
+    RUN_TEST(test_contiguous_segments_split_at_the_wrap);
+    RUN_TEST(test_two_threads_copying_reads);
+    RUN_TEST(test_two_threads_zero_copy_reads);
+    return UNITY_END();
+}
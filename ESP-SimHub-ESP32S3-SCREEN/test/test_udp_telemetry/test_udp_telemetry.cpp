@@ -0,0 +1,353 @@
+// Host tests for the UDP telemetry slot (lib/TcpSerialBridge2/TelemetrySlot.h):
+//  sequencing rules, then the same 60 Hz frames sent through real TCP and UDP
+//  sockets on 127.0.0.1, with the arrival jitter measured by TelemetrySlot.
+//  Loopback itself never loses anything, so the sender injects the same losses
+//  and air time into both: a lost UDP datagram is just not sent, a lost TCP
+//  segment holds back every frame behind it until the retransmit, then they
+//  all go out in one burst, as the receiver's stack would hand them up.
+
+#include <unity.h>
+#include <TelemetrySlot.h>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#include <chrono>
+#include <string>
+#include <thread>
+#include <vector>
+
+#define LINK_FRAME_INTERVAL_US  16667   // SimHub custom protocol at 60 Hz
+#define LINK_FRAMES             120     // two seconds per transport
+#define LINK_AIR_JITTER_US      500     // random air time added by the sender
+#define LINK_LOSS_ONE_IN        12
+// a lost TCP segment comes back by fast retransmit: three more segments for the
+//  duplicate ACKs, then one Wi-Fi round trip. Optimistic for TCP, the RTO is much longer
+#define LINK_TCP_RECOVERY_US    (3 * LINK_FRAME_INTERVAL_US + 4000)
+#define LINK_RECEIVE_TIMEOUT_MS 300     // UDP has no end of stream
+
+static TelemetrySlot *slot;
+
+void setUp(void)
+{
+    slot = new TelemetrySlot();
+}
+
+void tearDown(void)
+{
+    delete slot;
+}
+
+static size_t datagram(uint8_t *buffer, uint32_t sequence, const char *text)
+{
+    buffer[0] = sequence;
+    buffer[1] = sequence >> 8;
+    buffer[2] = sequence >> 16;
+    buffer[3] = sequence >> 24;
+    size_t length = strlen(text);
+    memcpy(buffer + UDP_TELEMETRY_HEADER_SIZE, text, length);
+    return UDP_TELEMETRY_HEADER_SIZE + length;
+}
+
+static bool offer(uint32_t sequence, const char *text, uint32_t nowMs = 0)
+{
+    uint8_t buffer[UDP_TELEMETRY_HEADER_SIZE + UDP_TELEMETRY_MAX_FRAME];
+    return slot->offer(buffer, datagram(buffer, sequence, text), nowMs, nowMs * 1000);
+}
+
+void test_newest_frame_replaces_unread_one(void)
+{
+    TEST_ASSERT_TRUE(offer(1, "100;3;50\n"));
+    TEST_ASSERT_TRUE(offer(2, "120;4;60\n"));
+
+    char frame[UDP_TELEMETRY_MAX_FRAME];
+    size_t length = slot->take(frame, sizeof(frame));
+    TEST_ASSERT_EQUAL_UINT32(9, length);
+    TEST_ASSERT_EQUAL_MEMORY("120;4;60\n", frame, length);
+    TEST_ASSERT_EQUAL_UINT32(0, slot->take(frame, sizeof(frame)));
+    TEST_ASSERT_EQUAL_UINT32(1, slot->getStats().superseded);
+}
+
+void test_late_and_duplicate_frames_are_dropped(void)
+{
+    TEST_ASSERT_TRUE(offer(5, "new"));
+    TEST_ASSERT_FALSE(offer(4, "late"));
+    TEST_ASSERT_FALSE(offer(5, "again"));
+
+    char frame[UDP_TELEMETRY_MAX_FRAME];
+    size_t length = slot->take(frame, sizeof(frame));
+    TEST_ASSERT_EQUAL_MEMORY("new", frame, length);
+    TEST_ASSERT_EQUAL_UINT32(2, slot->getStats().stale);
+}
+
+void test_sequence_gaps_count_as_lost(void)
+{
+    offer(1, "a");
+    offer(4, "b");
+    offer(5, "c");
+    TEST_ASSERT_EQUAL_UINT32(2, slot->getStats().lost);
+}
+
+void test_restarted_sender_is_accepted(void)
+{
+    offer(5000, "before restart");
+    TEST_ASSERT_TRUE(offer(0, "after restart"));
+    TEST_ASSERT_EQUAL_UINT32(0, slot->getStats().stale);
+}
+
+void test_sequence_wraps_around(void)
+{
+    offer(0xFFFFFFFE, "before wrap");
+    TEST_ASSERT_TRUE(offer(1, "after wrap"));
+    TEST_ASSERT_EQUAL_UINT32(2, slot->getStats().lost);
+}
+
+void test_malformed_datagrams_are_ignored(void)
+{
+    uint8_t header[UDP_TELEMETRY_HEADER_SIZE] = {1, 0, 0, 0};
+    TEST_ASSERT_FALSE(slot->offer(header, sizeof(header), 0, 0));
+
+    static uint8_t oversized[UDP_TELEMETRY_HEADER_SIZE + UDP_TELEMETRY_MAX_FRAME + 1];
+    TEST_ASSERT_FALSE(slot->offer(oversized, sizeof(oversized), 0, 0));
+    TEST_ASSERT_EQUAL_UINT32(0, slot->getStats().received);
+}
+
+void test_stream_frames_yield_while_udp_is_live(void)
+{
+    TEST_ASSERT_TRUE(slot->acceptStreamFrame(0, 0));
+    offer(1, "udp", 1000);
+    TEST_ASSERT_FALSE(slot->acceptStreamFrame(1000 + UDP_TELEMETRY_HOLD_MS - 1, 0));
+    TEST_ASSERT_TRUE(slot->acceptStreamFrame(1000 + UDP_TELEMETRY_HOLD_MS, 0));
+}
+
+struct LinkPlan {
+    std::vector<uint32_t> airUs;
+    std::vector<bool> lost;
+};
+
+// Same losses and air time for both transports. The last frames always go out,
+//  so a TCP hold never outlives the run
+static LinkPlan planLink()
+{
+    LinkPlan plan;
+    uint32_t seed = 0x2545F491;
+    for (uint32_t i = 0; i < LINK_FRAMES; i++)
+    {
+        seed ^= seed << 13;
+        seed ^= seed >> 17;
+        seed ^= seed << 5;
+        plan.airUs.push_back(seed % LINK_AIR_JITTER_US);
+        plan.lost.push_back(i > 0 && i < LINK_FRAMES - 4 && (seed >> 8) % LINK_LOSS_ONE_IN == 0);
+    }
+    return plan;
+}
+
+typedef std::chrono::steady_clock LinkClock;
+
+static uint32_t elapsedUs(LinkClock::time_point start)
+{
+    // never 0: FrameJitter takes 0 as "no previous frame"
+    return 1000000 + std::chrono::duration_cast<std::chrono::microseconds>(LinkClock::now() - start).count();
+}
+
+static void sleepUntilUs(LinkClock::time_point start, uint64_t us)
+{
+    std::this_thread::sleep_until(start + std::chrono::microseconds(us));
+}
+
+static std::string linkFrame(uint32_t sequence)
+{
+    char text[32];
+    snprintf(text, sizeof(text), "%u;180;6;75;90\n", sequence);
+    return text;
+}
+
+static void loopbackSocket(int type, int *fd, uint16_t *port)
+{
+    *fd = socket(AF_INET, type, 0);
+    TEST_ASSERT_TRUE(*fd >= 0);
+    sockaddr_in address = {};
+    address.sin_family = AF_INET;
+    address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    TEST_ASSERT_EQUAL_INT(0, bind(*fd, (sockaddr *)&address, sizeof(address)));
+    socklen_t length = sizeof(address);
+    getsockname(*fd, (sockaddr *)&address, &length);
+    *port = ntohs(address.sin_port);
+}
+
+static sockaddr_in loopbackAddress(uint16_t port)
+{
+    sockaddr_in address = {};
+    address.sin_family = AF_INET;
+    address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    address.sin_port = htons(port);
+    return address;
+}
+
+// In order: from a lost segment on, frames wait in the sender until the
+//  retransmit and then leave in one write
+static void sendTcp(uint16_t port, const LinkPlan *plan, LinkClock::time_point start)
+{
+    int fd = socket(AF_INET, SOCK_STREAM, 0);
+    int noDelay = 1;
+    setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &noDelay, sizeof(noDelay));
+    sockaddr_in address = loopbackAddress(port);
+    connect(fd, (sockaddr *)&address, sizeof(address));
+
+    std::string held;
+    uint64_t releaseUs = 0;
+    for (uint32_t i = 0; i < LINK_FRAMES; i++)
+    {
+        uint64_t dueUs = (uint64_t)i * LINK_FRAME_INTERVAL_US + plan->airUs[i];
+        if (releaseUs && releaseUs <= dueUs)
+        {
+            sleepUntilUs(start, releaseUs);
+            send(fd, held.data(), held.size(), 0);
+            held.clear();
+            releaseUs = 0;
+        }
+        sleepUntilUs(start, dueUs);
+        if (!releaseUs && plan->lost[i])
+            releaseUs = dueUs + LINK_TCP_RECOVERY_US;
+        if (releaseUs)
+        {
+            held += linkFrame(i);
+            continue;
+        }
+        std::string frame = linkFrame(i);
+        send(fd, frame.data(), frame.size(), 0);
+    }
+    if (!held.empty())
+    {
+        sleepUntilUs(start, releaseUs);
+        send(fd, held.data(), held.size(), 0);
+    }
+    close(fd);
+}
+
+static void sendUdp(uint16_t port, const LinkPlan *plan, LinkClock::time_point start)
+{
+    int fd = socket(AF_INET, SOCK_DGRAM, 0);
+    sockaddr_in address = loopbackAddress(port);
+    uint8_t buffer[UDP_TELEMETRY_HEADER_SIZE + UDP_TELEMETRY_MAX_FRAME];
+    for (uint32_t i = 0; i < LINK_FRAMES; i++)
+    {
+        sleepUntilUs(start, (uint64_t)i * LINK_FRAME_INTERVAL_US + plan->airUs[i]);
+        if (plan->lost[i])
+            continue;
+        size_t length = datagram(buffer, i, linkFrame(i).c_str());
+        sendto(fd, buffer, length, 0, (sockaddr *)&address, sizeof(address));
+    }
+    close(fd);
+}
+
+struct LinkReplay {
+    uint32_t jitterUs;   // running jitter estimate, averaged over the run
+    uint32_t maxGapUs;   // longest time the display waited for a new frame
+    uint32_t frames;
+};
+
+static void markArrival(LinkReplay &result, uint32_t &previousUs, uint32_t arrivalUs, uint32_t jitterUs, uint64_t &jitterSum)
+{
+    jitterSum += jitterUs;
+    if (previousUs && arrivalUs - previousUs > result.maxGapUs)
+        result.maxGapUs = arrivalUs - previousUs;
+    previousUs = arrivalUs;
+    result.frames++;
+}
+
+static LinkReplay receiveTcp(const LinkPlan &plan)
+{
+    int listener;
+    uint16_t port;
+    loopbackSocket(SOCK_STREAM, &listener, &port);
+    listen(listener, 1);
+    LinkClock::time_point start = LinkClock::now();
+    std::thread sender(sendTcp, port, &plan, start);
+    int fd = accept(listener, nullptr, nullptr);
+
+    // the stream copies go through the same jitter estimate the firmware shows
+    TelemetrySlot stream;
+    LinkReplay result = {};
+    uint32_t previousUs = 0;
+    uint64_t jitterSum = 0;
+    char buffer[1024];
+    ssize_t length;
+    while ((length = recv(fd, buffer, sizeof(buffer), 0)) > 0)
+    {
+        uint32_t arrivalUs = elapsedUs(start);
+        for (ssize_t i = 0; i < length; i++)
+        {
+            if (buffer[i] != '\n')
+                continue;
+            stream.acceptStreamFrame(arrivalUs / 1000, arrivalUs);
+            markArrival(result, previousUs, arrivalUs, stream.getStats().streamJitterUs, jitterSum);
+        }
+    }
+    sender.join();
+    close(fd);
+    close(listener);
+    result.jitterUs = result.frames ? jitterSum / result.frames : 0;
+    return result;
+}
+
+static LinkReplay receiveUdp(const LinkPlan &plan)
+{
+    int fd;
+    uint16_t port;
+    loopbackSocket(SOCK_DGRAM, &fd, &port);
+    timeval timeout = {0, LINK_RECEIVE_TIMEOUT_MS * 1000};
+    setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+    LinkClock::time_point start = LinkClock::now();
+    std::thread sender(sendUdp, port, &plan, start);
+
+    uint8_t buffer[UDP_TELEMETRY_HEADER_SIZE + UDP_TELEMETRY_MAX_FRAME];
+    LinkReplay result = {};
+    uint32_t previousUs = 0;
+    uint64_t jitterSum = 0;
+    ssize_t length;
+    while ((length = recv(fd, buffer, sizeof(buffer), 0)) > 0)
+    {
+        uint32_t arrivalUs = elapsedUs(start);
+        if (slot->offer(buffer, length, arrivalUs / 1000, arrivalUs))
+            markArrival(result, previousUs, arrivalUs, slot->getStats().udpJitterUs, jitterSum);
+    }
+    sender.join();
+    close(fd);
+    result.jitterUs = result.frames ? jitterSum / result.frames : 0;
+    return result;
+}
+
+void test_udp_cuts_jitter_on_a_lossy_link(void)
+{
+    LinkPlan plan = planLink();
+    LinkReplay tcp = receiveTcp(plan);
+    LinkReplay udp = receiveUdp(plan);
+
+    char message[160];
+    snprintf(message, sizeof(message), "127.0.0.1 tcp: jitter %u us, max gap %u us | udp: jitter %u us, max gap %u us, %u lost",
+             tcp.jitterUs, tcp.maxGapUs, udp.jitterUs, udp.maxGapUs, slot->getStats().lost);
+    TEST_MESSAGE(message);
+
+    TEST_ASSERT_EQUAL_UINT32(LINK_FRAMES, tcp.frames);
+    TEST_ASSERT_EQUAL_UINT32(LINK_FRAMES - slot->getStats().lost, udp.frames);
+    TEST_ASSERT_GREATER_THAN_UINT32(0, slot->getStats().lost);
+    // a loss costs UDP one frame interval, and TCP the whole recovery plus a burst
+    TEST_ASSERT_LESS_THAN_UINT32(tcp.jitterUs, udp.jitterUs);
+    TEST_ASSERT_LESS_THAN_UINT32(tcp.maxGapUs, udp.maxGapUs);
+}
+
+int main(int argc, char **argv)
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_newest_frame_replaces_unread_one);
+    RUN_TEST(test_late_and_duplicate_frames_are_dropped);
+    RUN_TEST(test_sequence_gaps_count_as_lost);
+    RUN_TEST(test_restarted_sender_is_accepted);
+    RUN_TEST(test_sequence_wraps_around);
+    RUN_TEST(test_malformed_datagrams_are_ignored);
+    RUN_TEST(test_stream_frames_yield_while_udp_is_live);
+    RUN_TEST(test_udp_cuts_jitter_on_a_lossy_link);
+    return UNITY_END();
+}
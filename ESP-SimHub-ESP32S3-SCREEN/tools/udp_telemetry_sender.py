@@ -0,0 +1,84 @@
+#!/usr/bin/env python3
+"""Feeds the wheel's UDP telemetry port (UDP_TELEMETRY_PORT in src/Config.h).
+
+Sends the same text frame the custom protocol gets over the TCP bridge, with a
+4-byte little-endian sequence number in front, at a fixed rate. --loss and
+--reorder drop or swap datagrams on purpose to exercise the newest-wins path;
+build with DEBUG_TCP_BRIDGE to see the frame/stale/lost/jitter line on Serial.
+
+    python3 tools/udp_telemetry_sender.py 192.168.1.50 --rate 60 --loss 0.02
+"""
+
+import argparse
+import random
+import socket
+import struct
+import time
+
+
+def frame(index, rate):
+    t = index / rate
+    rpm = int(50 + 50 * abs((t % 4) / 2 - 1))  # 0-100% sweep every 4 s
+    fields = [
+        120 + int(rpm * 1.5),    # speed
+        1 + rpm // 20,           # gear
+        rpm,                     # rpm %
+        90,                      # redline %
+        "1:%06.3f" % (t % 60),   # current lap
+        "1:31.204",              # last lap
+        "1:30.877",              # best lap
+        "-0.12", "0.40",         # session best delta, delta progress
+        "23.1", "23.0", "22.4", "22.5",
+        4, 0, 3, 0, 0, 0,        # TC level/active, ABS level/active, TC cut
+        "56.0",                  # brake bias
+        0,                       # brake
+        0,                       # lap invalidated
+    ]
+    return (";".join(str(f) for f in fields) + "\n").encode()
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument("host")
+    parser.add_argument("--port", type=int, default=10002)
+    parser.add_argument("--rate", type=float, default=60, help="frames per second")
+    parser.add_argument("--seconds", type=float, default=30)
+    parser.add_argument("--loss", type=float, default=0, help="fraction of datagrams not sent")
+    parser.add_argument("--reorder", type=float, default=0, help="fraction sent after the next one")
+    args = parser.parse_args()
+
+    sock = socket.socket(socket.AF_INET, socket.SOCK_DGRAM)
+    interval = 1 / args.rate
+    total = int(args.seconds * args.rate)
+    held = None
+    sent = dropped = swapped = 0
+    start = time.perf_counter()
+
+    for sequence in range(total):
+        datagram = struct.pack("<I", sequence) + frame(sequence, args.rate)
+        if random.random() < args.loss:
+            dropped += 1
+        elif held is None and random.random() < args.reorder:
+            held = datagram
+        else:
+            sock.sendto(datagram, (args.host, args.port))
+            sent += 1
+            if held is not None:
+                sock.sendto(held, (args.host, args.port))
+                sent += 1
+                swapped += 1
+                held = None
+
+        delay = start + (sequence + 1) * interval - time.perf_counter()
+        if delay > 0:
+            time.sleep(delay)
+
+    if held is not None:
+        sock.sendto(held, (args.host, args.port))
+        sent += 1
+
+    print("%d frames: %d sent, %d dropped, %d reordered" % (total, sent, dropped, swapped))
+
+
+if __name__ == "__main__":
+    main()